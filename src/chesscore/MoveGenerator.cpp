@@ -29,9 +29,6 @@
 static constexpr bool REMOVE_SORT_VALUE = true;
 
 MoveGenerator::MoveGenerator() {
-  pseudoLegalMoves.reserve(MAX_MOVES);
-  legalMoves.reserve(MAX_MOVES);
-  onDemandMoves.reserve(MAX_MOVES);
   currentODStage = OD_NEW;
 }
 
@@ -64,7 +61,7 @@ const MoveList* MoveGenerator::generatePseudoLegalMoves(const Position& p, const
   updateSortValues(p, &pseudoLegalMoves);
 
   // sort moves
-  std::stable_sort(pseudoLegalMoves.begin(), pseudoLegalMoves.end(), moveValueGreaterComparator());
+  sortMovesByValue(pseudoLegalMoves.begin(), pseudoLegalMoves.end());
 
   // remove internal sort value
   if (REMOVE_SORT_VALUE) {
@@ -77,9 +74,19 @@ const MoveList* MoveGenerator::generatePseudoLegalMoves(const Position& p, const
 
 const MoveList* MoveGenerator::generateLegalMoves(const Position& p, const GenMode genMode) {
   legalMoves.clear();
+  // the evasion targets cover the checkers - with more than one checker
+  // only king moves are generated
   generatePseudoLegalMoves(p, genMode, p.hasCheck());
-  for (Move m : pseudoLegalMoves) {
-    if (p.isLegalMove(m)) legalMoves.push_back(m);
+  if (legalMode == LegalByMasks) {
+    const Bitboard pinned = p.pinnedPieces(p.getNextPlayer());
+    for (Move m : pseudoLegalMoves) {
+      if (p.isLegalMove(m, pinned)) legalMoves.push_back(m);
+    }
+  }
+  else {
+    for (Move m : pseudoLegalMoves) {
+      if (p.isLegalMove(m)) legalMoves.push_back(m);
+    }
   }
   return &legalMoves;
 }
@@ -165,6 +172,24 @@ Move MoveGenerator::getNextPseudoLegalMove(const Position& p, const GenMode genM
   return MOVE_NONE;
 }
 
+void MoveGenerator::generateStageMoves(const Position& p, MoveList* const pMoves, const GenMode genMode, const bool evasion) {
+  assert((genMode == GenNonQuiet || genMode == GenQuiet) && "stage moves are generated for one mode at a time");
+
+  // when in check only generate moves either blocking or capturing the attacker
+  Bitboard evasionTargets = BbZero;
+  if (evasion) {
+    assert(p.hasCheck() && "move generator called with evasion true but not in check");
+    evasionTargets = getEvasionTargets(p);
+  }
+
+  generatePawnMoves(p, pMoves, genMode, evasion, evasionTargets);
+  if (genMode == GenQuiet && !evasion) {// no castling when in check
+    generateCastling(p, pMoves, GenQuiet);
+  }
+  generateMoves(p, pMoves, genMode, evasion, evasionTargets);
+  generateKingMoves(p, pMoves, genMode, evasion);
+}
+
 void MoveGenerator::setPV(Move move) {
   pvMove = moveOf(move);
 }
@@ -548,7 +573,7 @@ void MoveGenerator::fillOnDemandMoveList(const Position& position, const GenMode
     }
     // sort the list according to sort values encoded in the move
     if (!onDemandMoves.empty()) {
-      std::stable_sort(onDemandMoves.begin(), onDemandMoves.end(), moveValueGreaterComparator());
+      sortMovesByValue(onDemandMoves.begin(), onDemandMoves.end());
     }
   }// while onDemandMoves.empty()
 }
@@ -625,15 +650,41 @@ Bitboard MoveGenerator::getEvasionTargets(const Position& p) {
 }
 
 void MoveGenerator::generatePawnMoves(const Position& position, MoveList* const pMoves, const GenMode genMode, const bool evasion, const Bitboard evasionTargets) {
+  // dispatch to the variant specialized for the side to move and the mode
+  const bool white = position.getNextPlayer() == WHITE;
+  switch (genMode) {
+    case GenNonQuiet:
+      white ? generatePawnMoves<WHITE, GenNonQuiet>(position, pMoves, evasion, evasionTargets)
+            : generatePawnMoves<BLACK, GenNonQuiet>(position, pMoves, evasion, evasionTargets);
+      break;
+    case GenQuiet:
+      white ? generatePawnMoves<WHITE, GenQuiet>(position, pMoves, evasion, evasionTargets)
+            : generatePawnMoves<BLACK, GenQuiet>(position, pMoves, evasion, evasionTargets);
+      break;
+    case GenAll:
+      white ? generatePawnMoves<WHITE, GenAll>(position, pMoves, evasion, evasionTargets)
+            : generatePawnMoves<BLACK, GenAll>(position, pMoves, evasion, evasionTargets);
+      break;
+    default:
+      break;
+  }
+}
+
+template<Color us, GenMode genMode>
+void MoveGenerator::generatePawnMoves(const Position& position, MoveList* const pMoves, const bool evasion, const Bitboard evasionTargets) {
+  // directions and ranks are compile time constants for the side to move
+  constexpr Color them      = ~us;
+  constexpr Direction up    = pawnPush(us);
+  constexpr Direction down  = pawnPush(them);
+  const Bitboard promRankBb = Bitboards::rankBb[promotionRank(us)];
 
-  const Color nextPlayer = position.getNextPlayer();
-  const Bitboard myPawns = position.getPieceBb(nextPlayer, PAWN);
+  const Bitboard myPawns = position.getPieceBb(us, PAWN);
 
-  const Piece piece   = makePiece(nextPlayer, PAWN);
+  const Piece piece   = makePiece(us, PAWN);
   const int gamePhase = position.getGamePhase();
 
   // captures
-  if (genMode & GenNonQuiet) {
+  if constexpr ((genMode & GenNonQuiet) != 0) {
 
     // This algorithm shifts the own pawn bitboard in the direction of pawn captures
     // and ANDs it with the opponents pieces. With this we get all possible captures
@@ -647,52 +698,18 @@ void MoveGenerator::generatePawnMoves(const Position& position, MoveList* const
     // target these evasion squares. That is either capturing the attacker or blocking
     // a sliding attacker.
 
-    Bitboard tmpCaptures, promCaptures;
-
-    for (Direction dir : {WEST, EAST}) {
-      // normal pawn captures - promotions first
-      tmpCaptures = shiftBb(pawnPush(nextPlayer) + dir, myPawns) & position.getOccupiedBb(~nextPlayer);
-
-      // filter evasion targets if in check
-      if (evasion) {
-        tmpCaptures &= evasionTargets;
-      }
-
-      // normal pawn captures - promotions first
-      promCaptures = tmpCaptures & Bitboards::rankBb[promotionRank(nextPlayer)];
-      // promotion captures
-      while (promCaptures) {
-        const Square toSquare   = popLSB(promCaptures);
-        const Square fromSquare = toSquare + pawnPush(~nextPlayer) - dir;
-        // value is the delta of values from the two pieces involved minus the promotion value
-        const Value value = valueOf(position.getPiece(toSquare)) - (2 * valueOf(PAWN));
-        // add the possible promotion moves to the move list and also add value of the promoted piece type
-        pMoves->push_back(createMove(fromSquare, toSquare, PROMOTION, QUEEN, value + valueOf(QUEEN) + 5000));
-        pMoves->push_back(createMove(fromSquare, toSquare, PROMOTION, KNIGHT, value + valueOf(KNIGHT) + 1500));
-        // rook and bishops are usually redundant to queen promotion (except in stale mate situations)
-        // therefore we give them a lower sort order
-        pMoves->push_back(createMove(fromSquare, toSquare, PROMOTION, ROOK, value + valueOf(ROOK) - 5000));
-        pMoves->push_back(createMove(fromSquare, toSquare, PROMOTION, BISHOP, value + valueOf(BISHOP) - 5000));
-      }
-
-      tmpCaptures &= ~Bitboards::rankBb[promotionRank(nextPlayer)];
-      while (tmpCaptures) {
-        const Square toSquare   = popLSB(tmpCaptures);
-        const Square fromSquare = toSquare + pawnPush(~nextPlayer) - dir;
-        // value is the delta of values from the two pieces involved plus the positional value
-        const Value value = valueOf(position.getPiece(toSquare)) - valueOf(position.getPiece(fromSquare)) + Values::posValue[piece][toSquare][gamePhase];
-        pMoves->push_back(createMove(fromSquare, toSquare, NORMAL, value));
-      }
-    }
+    // normal pawn captures - west first then east
+    generatePawnCaptures<us, WEST>(position, pMoves, myPawns, evasion, evasionTargets);
+    generatePawnCaptures<us, EAST>(position, pMoves, myPawns, evasion, evasionTargets);
 
     // en passant captures
     const Square enPassantSquare = position.getEnPassantSquare();
     if (enPassantSquare != SQ_NONE) {
       for (Direction dir : {WEST, EAST}) {
-        tmpCaptures = shiftBb(pawnPush(~nextPlayer) + dir, Bitboards::sqBb[enPassantSquare]) & myPawns;
+        const Bitboard tmpCaptures = shiftBb(down + dir, Bitboards::sqBb[enPassantSquare]) & myPawns;
         if (tmpCaptures) {
           Square fromSquare = lsb(tmpCaptures);
-          Square toSquare   = fromSquare + pawnPush(nextPlayer) - dir;
+          Square toSquare   = fromSquare + up - dir;
           // value is the positional value of the piece at this game phase
           pMoves->push_back(createMove(fromSquare, toSquare, ENPASSANT, Values::posValue[piece][toSquare][gamePhase]));
         }
@@ -700,7 +717,7 @@ void MoveGenerator::generatePawnMoves(const Position& position, MoveList* const
     }
 
     // we treat Queen and Knight promotions as non quiet moves
-    Bitboard promMoves = shiftBb(pawnPush(nextPlayer), myPawns) & ~position.getOccupiedBb() & Bitboards::rankBb[promotionRank(nextPlayer)];
+    Bitboard promMoves = shiftBb<up>(myPawns) & ~position.getOccupiedBb() & promRankBb;
 
     // filter evasion targets if in check
     if (evasion) {
@@ -709,7 +726,7 @@ void MoveGenerator::generatePawnMoves(const Position& position, MoveList* const
     // single pawn steps - promotions first
     while (promMoves) {
       const Square toSquare   = popLSB(promMoves);
-      const Square fromSquare = toSquare + pawnPush(~nextPlayer);
+      const Square fromSquare = toSquare + down;
       // value for non captures is lowered by 10k
       // value is done manually for sorting of queen prom first, then knight and others
       pMoves->push_back(createMove(fromSquare, toSquare, PROMOTION, QUEEN, 2000 - valueOf(PAWN) + valueOf(QUEEN)));
@@ -718,7 +735,7 @@ void MoveGenerator::generatePawnMoves(const Position& position, MoveList* const
   }
 
   // non captures
-  if (genMode & GenQuiet) {
+  if constexpr ((genMode & GenQuiet) != 0) {
 
     //  Move my pawns forward one step and keep all on not occupied squares
     //  Move pawns now on rank 3 (rank 6) another square forward to check for pawn doubles.
@@ -729,10 +746,10 @@ void MoveGenerator::generatePawnMoves(const Position& position, MoveList* const
     // a sliding attacker.
 
     // pawns - check step one to unoccupied squares
-    Bitboard tmpMoves = shiftBb(pawnPush(nextPlayer), myPawns) & ~position.getOccupiedBb();
+    Bitboard tmpMoves = shiftBb<up>(myPawns) & ~position.getOccupiedBb();
 
     // pawns double - check step two to unoccupied squares
-    Bitboard tmpMovesDouble = shiftBb(pawnPush(nextPlayer), tmpMoves & Bitboards::rankBb[pawnDoubleRank(nextPlayer)]) & ~position.getOccupiedBb();
+    Bitboard tmpMovesDouble = shiftBb<up>(tmpMoves & Bitboards::rankBb[pawnDoubleRank(us)]) & ~position.getOccupiedBb();
 
     // filter evasion targets if in check
     if (evasion) {
@@ -741,10 +758,10 @@ void MoveGenerator::generatePawnMoves(const Position& position, MoveList* const
     }
 
     // single pawn steps - promotions first
-    Bitboard promMoves = tmpMoves & Bitboards::rankBb[promotionRank(nextPlayer)];
+    Bitboard promMoves = tmpMoves & promRankBb;
     while (promMoves) {
       const Square toSquare   = popLSB(promMoves);
-      const Square fromSquare = toSquare + pawnPush(~nextPlayer);
+      const Square fromSquare = toSquare + down;
       // value for non captures is lowered
       // we treat Queen and Knight promotions as non quiet moves and they are generated above
       // rook and bishops are usually redundant to queen promotion (except in stale mate situations)
@@ -758,14 +775,14 @@ void MoveGenerator::generatePawnMoves(const Position& position, MoveList* const
       const Square toSquare = popLSB(tmpMovesDouble);
       // value is the positional value of the piece at this game phase
       const auto value = Values::posValue[piece][toSquare][gamePhase] - 2'000;
-      pMoves->push_back(createMove(toSquare + 2 * pawnPush(~nextPlayer), toSquare, NORMAL, value));
+      pMoves->push_back(createMove(toSquare + down + down, toSquare, NORMAL, value));
     }
 
     // normal single pawn steps
-    tmpMoves = tmpMoves & ~Bitboards::rankBb[promotionRank(nextPlayer)];
+    tmpMoves = tmpMoves & ~promRankBb;
     while (tmpMoves) {
       const Square toSquare   = popLSB(tmpMoves);
-      const Square fromSquare = toSquare + pawnPush(~nextPlayer);
+      const Square fromSquare = toSquare + down;
       // value is the positional value of the piece at this game phase
       const Value value = Values::posValue[piece][toSquare][gamePhase] - 2'000;
       pMoves->push_back(createMove(fromSquare, toSquare, NORMAL, value));
@@ -773,9 +790,72 @@ void MoveGenerator::generatePawnMoves(const Position& position, MoveList* const
   }
 }
 
+template<Color us, Direction dir>
+void MoveGenerator::generatePawnCaptures(const Position& position, MoveList* const pMoves, const Bitboard myPawns, const bool evasion, const Bitboard evasionTargets) {
+  constexpr Direction down  = pawnPush(~us);
+  const Bitboard promRankBb = Bitboards::rankBb[promotionRank(us)];
+  const Piece piece         = makePiece(us, PAWN);
+  const int gamePhase       = position.getGamePhase();
+
+  Bitboard tmpCaptures = shiftBb<pawnPush(us) + dir>(myPawns) & position.getOccupiedBb(~us);
+
+  // filter evasion targets if in check
+  if (evasion) {
+    tmpCaptures &= evasionTargets;
+  }
+
+  // normal pawn captures - promotions first
+  Bitboard promCaptures = tmpCaptures & promRankBb;
+  // promotion captures
+  while (promCaptures) {
+    const Square toSquare   = popLSB(promCaptures);
+    const Square fromSquare = toSquare + down - dir;
+    // value is the delta of values from the two pieces involved minus the promotion value
+    const Value value = valueOf(position.getPiece(toSquare)) - (2 * valueOf(PAWN));
+    // add the possible promotion moves to the move list and also add value of the promoted piece type
+    pMoves->push_back(createMove(fromSquare, toSquare, PROMOTION, QUEEN, value + valueOf(QUEEN) + 5000));
+    pMoves->push_back(createMove(fromSquare, toSquare, PROMOTION, KNIGHT, value + valueOf(KNIGHT) + 1500));
+    // rook and bishops are usually redundant to queen promotion (except in stale mate situations)
+    // therefore we give them a lower sort order
+    pMoves->push_back(createMove(fromSquare, toSquare, PROMOTION, ROOK, value + valueOf(ROOK) - 5000));
+    pMoves->push_back(createMove(fromSquare, toSquare, PROMOTION, BISHOP, value + valueOf(BISHOP) - 5000));
+  }
+
+  tmpCaptures &= ~promRankBb;
+  while (tmpCaptures) {
+    const Square toSquare   = popLSB(tmpCaptures);
+    const Square fromSquare = toSquare + down - dir;
+    // value is the delta of values from the two pieces involved plus the positional value
+    const Value value = valueOf(position.getPiece(toSquare)) - valueOf(position.getPiece(fromSquare)) + Values::posValue[piece][toSquare][gamePhase];
+    pMoves->push_back(createMove(fromSquare, toSquare, NORMAL, value));
+  }
+}
+
 void MoveGenerator::generateMoves(const Position& position, MoveList* const pMoves, const GenMode genMode, const bool evasion, const Bitboard evasionTargets) {
-  const Color nextPlayer    = position.getNextPlayer();
+  // dispatch to the variant specialized for the side to move and the mode
+  const bool white = position.getNextPlayer() == WHITE;
+  switch (genMode) {
+    case GenNonQuiet:
+      white ? generateMoves<WHITE, GenNonQuiet>(position, pMoves, evasion, evasionTargets)
+            : generateMoves<BLACK, GenNonQuiet>(position, pMoves, evasion, evasionTargets);
+      break;
+    case GenQuiet:
+      white ? generateMoves<WHITE, GenQuiet>(position, pMoves, evasion, evasionTargets)
+            : generateMoves<BLACK, GenQuiet>(position, pMoves, evasion, evasionTargets);
+      break;
+    case GenAll:
+      white ? generateMoves<WHITE, GenAll>(position, pMoves, evasion, evasionTargets)
+            : generateMoves<BLACK, GenAll>(position, pMoves, evasion, evasionTargets);
+      break;
+    default:
+      break;
+  }
+}
+
+template<Color us, GenMode genMode>
+void MoveGenerator::generateMoves(const Position& position, MoveList* const pMoves, const bool evasion, const Bitboard evasionTargets) {
   const Bitboard occupiedBb = position.getOccupiedBb();
+  const Bitboard theirBb    = position.getOccupiedBb(~us);
   const int gamePhase       = position.getGamePhase();
 
   // Loop through all piece types, get attacks for the piece.
@@ -784,28 +864,28 @@ void MoveGenerator::generateMoves(const Position& position, MoveList* const pMov
   // attacker or blocking a sliding attacker.
 
   for (PieceType pt = KNIGHT; pt <= QUEEN; ++pt) {
-    Bitboard pieces   = position.getPieceBb(nextPlayer, pt);
-    const Piece piece = makePiece(nextPlayer, pt);
+    Bitboard pieces   = position.getPieceBb(us, pt);
+    const Piece piece = makePiece(us, pt);
 
     while (pieces) {
       const Square fromSquare    = popLSB(pieces);
       const Bitboard pseudoMoves = getAttacksBb(pt, fromSquare, occupiedBb);
 
       // captures
-      if (genMode & GenNonQuiet) {
-        Bitboard captures = pseudoMoves & position.getOccupiedBb(~nextPlayer);
+      if constexpr ((genMode & GenNonQuiet) != 0) {
+        Bitboard captures = pseudoMoves & theirBb;
         if (evasion) {
           captures &= evasionTargets;
         }
         while (captures) {
           const Square toSquare = popLSB(captures);
-          const Value value     = 2000 + valueOf(position.getPiece(toSquare)) - valueOf(position.getPiece(fromSquare)) + Values::posValue[piece][toSquare][gamePhase];
+          const Value value     = 2000 + valueOf(position.getPiece(toSquare)) - valueOf(piece) + Values::posValue[piece][toSquare][gamePhase];
           pMoves->push_back(createMove(fromSquare, toSquare, NORMAL, value));
         }
       }
 
       // non captures
-      if (genMode & GenQuiet) {
+      if constexpr ((genMode & GenQuiet) != 0) {
         Bitboard nonCaptures = pseudoMoves & ~occupiedBb;
         if (evasion) {
           nonCaptures &= evasionTargets;
@@ -821,44 +901,57 @@ void MoveGenerator::generateMoves(const Position& position, MoveList* const pMov
 }
 
 void MoveGenerator::generateKingMoves(const Position& position, MoveList* const pMoves, const GenMode genMode, const bool evasion) {
-  const Color nextPlayer = position.getNextPlayer();
-  const Piece piece      = makePiece(nextPlayer, KING);
-  const int gamePhase    = position.getGamePhase();
-  Bitboard kingSquareBb  = position.getPieceBb(nextPlayer, KING);
-  assert(popcount(kingSquareBb) == 1 && "Only exactly one king allowed!");
-  const Square fromSquare = popLSB(kingSquareBb);
+  // dispatch to the variant specialized for the side to move and the mode
+  const bool white = position.getNextPlayer() == WHITE;
+  switch (genMode) {
+    case GenNonQuiet:
+      white ? generateKingMoves<WHITE, GenNonQuiet>(position, pMoves, evasion)
+            : generateKingMoves<BLACK, GenNonQuiet>(position, pMoves, evasion);
+      break;
+    case GenQuiet:
+      white ? generateKingMoves<WHITE, GenQuiet>(position, pMoves, evasion)
+            : generateKingMoves<BLACK, GenQuiet>(position, pMoves, evasion);
+      break;
+    case GenAll:
+      white ? generateKingMoves<WHITE, GenAll>(position, pMoves, evasion)
+            : generateKingMoves<BLACK, GenAll>(position, pMoves, evasion);
+      break;
+    default:
+      break;
+  }
+}
+
+template<Color us, GenMode genMode>
+void MoveGenerator::generateKingMoves(const Position& position, MoveList* const pMoves, const bool evasion) {
+  constexpr Color them = ~us;
+  const Piece piece    = makePiece(us, KING);
+  const int gamePhase  = position.getGamePhase();
+  assert(popcount(position.getPieceBb(us, KING)) == 1 && "Only exactly one king allowed!");
+  const Square fromSquare = position.getKingSquare(us);
 
   // attacks include all moves no matter if the king would be in check
   const Bitboard pseudoMoves = getAttacksBb(KING, fromSquare, BbZero);
 
   // captures
-  if (genMode & GenNonQuiet) {
-    Bitboard captures = pseudoMoves & position.getOccupiedBb(~nextPlayer);
+  if constexpr ((genMode & GenNonQuiet) != 0) {
+    Bitboard captures = pseudoMoves & position.getOccupiedBb(them);
     while (captures) {
       const Square toSquare = popLSB(captures);
-      if (!evasion) {
-        const Value value = 2000 + valueOf(position.getPiece(toSquare)) - valueOf(position.getPiece(fromSquare)) + Values::posValue[piece][toSquare][gamePhase];
-        pMoves->push_back(createMove(fromSquare, toSquare, NORMAL, value));
-      }
       // when evasion only move to non attacked squares - will not check for x-ray attacks
-      else if (!position.attacksTo(toSquare, ~nextPlayer)) {
-        const Value value = 2000 + valueOf(position.getPiece(toSquare)) - valueOf(position.getPiece(fromSquare)) + Values::posValue[piece][toSquare][gamePhase];
+      if (!evasion || !position.attacksTo(toSquare, them)) {
+        const Value value = 2000 + valueOf(position.getPiece(toSquare)) - valueOf(piece) + Values::posValue[piece][toSquare][gamePhase];
         pMoves->push_back(createMove(fromSquare, toSquare, NORMAL, value));
       }
     }
   }
 
   // non captures
-  if (genMode & GenQuiet) {
+  if constexpr ((genMode & GenQuiet) != 0) {
     Bitboard nonCaptures = pseudoMoves & ~position.getOccupiedBb();
     while (nonCaptures) {
       const Square toSquare = popLSB(nonCaptures);
-      if (!evasion) {
-        const Value value = Values::posValue[piece][toSquare][gamePhase] - 2'000;
-        pMoves->push_back(createMove(fromSquare, toSquare, NORMAL, value));
-      }
       // when evasion only move to non attacked squares - will not check for x-ray attacks
-      else if (!position.attacksTo(toSquare, ~nextPlayer)) {
+      if (!evasion || !position.attacksTo(toSquare, them)) {
         const Value value = Values::posValue[piece][toSquare][gamePhase] - 2'000;
         pMoves->push_back(createMove(fromSquare, toSquare, NORMAL, value));
       }
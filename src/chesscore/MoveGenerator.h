@@ -40,6 +40,17 @@ enum GenMode : uint8_t {
   GenAll      = 0b11
 };
 
+// LegalMode selects how generateLegalMoves determines legal moves.
+//  LegalByDoMove - each pseudo legal move is made on the position and the
+//                  king is tested for attacks
+//  LegalByMasks  - checkers and pinned pieces are computed once for the
+//                  position and only moves which are legal with regard to
+//                  these are emitted - no move needs to be made
+enum LegalMode : uint8_t {
+  LegalByDoMove,
+  LegalByMasks
+};
+
 // Class MoveGenerator contains functionality to create moves on a
 // chess position. It implements several variants like
 // generate pseudo legal moves, legal moves or on demand
@@ -71,6 +82,8 @@ class MoveGenerator {
                        OD_END };
   onDemandStage currentODStage;
 
+  LegalMode legalMode = LegalByMasks;
+
   Move pvMove          = MOVE_NONE;
   bool pvMovePushed    = false;
   Move killerMoves[2]  = {MOVE_NONE, MOVE_NONE};
@@ -118,8 +131,15 @@ public:
   // Usually only used for root moves generation as this is expensive. During
   // the AlphaBeta search we will only use pseudo legal move generation.
   // Other than generatePseudoLegalMoves this determines check and evasion itself.
+  // How legality is determined can be selected with setLegalMode(). The default
+  // uses pin and checker masks and does not need to make any move.
   const MoveList* generateLegalMoves(const Position& p, GenMode genMode);
 
+  // SetLegalMode selects how generateLegalMoves determines legal moves
+  void setLegalMode(LegalMode mode) { legalMode = mode; }
+
+  [[nodiscard]] LegalMode getLegalMode() const { return legalMode; }
+
   // GetNextMove is the main function for phased generation of pseudo legal moves.
   // It returns the next move for the given position and will usually be called in a
   // loop during search. As we hope for an early beta cut this will save time as not
@@ -148,6 +168,13 @@ public:
   // of these moves anyway.
   Move getNextPseudoLegalMove(const Position& p, GenMode genMode, bool evasion = false);
 
+  // GenerateStageMoves appends the pseudo legal moves of the given generation
+  // mode (GenNonQuiet or GenQuiet) to the given list. Moves carry their static
+  // sort value (MVV-LVA for captures, position value for quiet moves) but are
+  // neither sorted nor changed by pv, killer or history data. This is used
+  // by the MovePicker which does its own staging and ordering.
+  static void generateStageMoves(const Position& position, MoveList* pMoves, GenMode genMode, bool evasion);
+
   // Resets the move generator to start fresh. Clears all lists (e.g. killers) and resets on demand iterator
   inline void reset() {
     pseudoLegalMoves.clear();
@@ -243,26 +270,43 @@ private:
   // @param pMoves - generated moves will be added to this list
   static void generatePawnMoves(const Position& position, MoveList* pMoves, GenMode genMode, bool evasion, Bitboard evasionTargets);
 
+  // The generators are specialized at compile time on the side to move and
+  // the generation mode. This removes the mode branches and lets the compiler
+  // pick the pawn direction shifts. The non template versions above dispatch
+  // to these.
+  template<Color us, GenMode genMode>
+  static void generatePawnMoves(const Position& position, MoveList* pMoves, bool evasion, Bitboard evasionTargets);
+
+  // Generates pawn captures incl. capture promotions in one direction
+  template<Color us, Direction dir>
+  static void generatePawnCaptures(const Position& position, MoveList* pMoves, Bitboard myPawns, bool evasion, Bitboard evasionTargets);
+
   // Generates pseudo knight, bishop, rook and queen moves for the next player.
   // Does not check if king is left in check
   // @param genMode
   // @param pPosition
   // @param pMoves - generated moves will be added to this list
-  void generateMoves(const Position& position, MoveList* pMoves, GenMode genMode, bool evasion, Bitboard evasionTargets);
+  static void generateMoves(const Position& position, MoveList* pMoves, GenMode genMode, bool evasion, Bitboard evasionTargets);
+
+  template<Color us, GenMode genMode>
+  static void generateMoves(const Position& position, MoveList* pMoves, bool evasion, Bitboard evasionTargets);
 
   // Generates pseudo king moves for the next player. Does not check if king
   // lands on an attacked square.
   // @param genMode
   // @param pPosition
   // @param pMoves - generated moves will be added to this list
-  void generateKingMoves(const Position& position, MoveList* pMoves, GenMode genMode, bool evasion);
+  static void generateKingMoves(const Position& position, MoveList* pMoves, GenMode genMode, bool evasion);
+
+  template<Color us, GenMode genMode>
+  static void generateKingMoves(const Position& position, MoveList* pMoves, bool evasion);
 
   // Generates pseudo castling move for the next player. Does not check if king passes or lands on an
   // attacked square.
   // @param genMode
   // @param pPosition
   // @param pMoves - generated moves will be added to this list
-  void generateCastling(const Position& position, MoveList* pMoves, GenMode genMode);
+  static void generateCastling(const Position& position, MoveList* pMoves, GenMode genMode);
 
   FRIEND_TEST(MoveGenTest, pawnMoves);
   FRIEND_TEST(MoveGenTest, kingMoves);
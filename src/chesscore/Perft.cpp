@@ -17,13 +17,60 @@
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+#include <algorithm>
 #include <chrono>
+#include <future>
 #include <iomanip>
 #include <iostream>
 
 #include "Perft.h"
 #include "chesscore/MoveGenerator.h"
 #include "chesscore/Position.h"
+#include "common/ThreadPool.h"
+
+namespace {
+  // Generates the legal moves of the position in generation order. Perft
+  // does not need sorted moves so this uses the unsorted stage generation
+  // and filters with the pinned pieces of the position.
+  void generateLegalMoves(const Position& position, MoveList& moves) {
+    const bool evasion = position.hasCheck();
+    MoveGenerator::generateStageMoves(position, &moves, GenNonQuiet, evasion);
+    MoveGenerator::generateStageMoves(position, &moves, GenQuiet, evasion);
+    const Bitboard pinned = position.pinnedPieces(position.getNextPlayer());
+    const auto legalEnd   = std::remove_if(moves.begin(), moves.end(), [&](Move m) { return !position.isLegalMove(m, pinned); });
+    while (moves.end() != legalEnd) moves.pop_back();
+  }
+}// namespace
+
+Perft::PerftHash::PerftHash(std::size_t sizeInMB) {
+  // number of entries as largest power of 2 fitting into the given size
+  uint64_t size = 1;
+  while ((size << 1) * sizeof(Entry) <= sizeInMB * 1024 * 1024) size <<= 1;
+  entries = std::make_unique<Entry[]>(size);
+  mask    = size - 1;
+}
+
+// the depth is mixed into the key as the same position is reached at
+// different depths with different node counts
+static inline Key perftKey(Key key, int depth) {
+  return key ^ (static_cast<Key>(depth) * 0x9E3779B97F4A7C15ULL);
+}
+
+bool Perft::PerftHash::probe(Key key, int depth, uint64_t& nodes) const {
+  const Key hashKey  = perftKey(key, depth);
+  const Entry& entry = entries[hashKey & mask];
+  const uint64_t n   = entry.nodes.load(std::memory_order_relaxed);
+  if ((entry.check.load(std::memory_order_relaxed) ^ n) != hashKey) return false;
+  nodes = n;
+  return true;
+}
+
+void Perft::PerftHash::store(Key key, int depth, uint64_t nodes) {
+  const Key hashKey = perftKey(key, depth);
+  Entry& entry      = entries[hashKey & mask];
+  entry.nodes.store(nodes, std::memory_order_relaxed);
+  entry.check.store(hashKey ^ nodes, std::memory_order_relaxed);
+}
 
 Perft::Perft() {
   fen = START_POSITION_FEN;
@@ -41,8 +88,29 @@ void Perft::stop() {
   stopFlag = true;
 }
 
+uint64_t Perft::countNodes(int depth) {
+  stopFlag = false;
+  resetCounter();
+  Position position;
+  try {
+    position = Position(fen);
+  } catch (std::invalid_argument& e) {
+    return 0;
+  }
+  const bool bulk = bulkCounting;
+  bulkCounting    = true;
+  nodes           = threads > 1 && depth > 1 ? countParallel(depth, position, false) : count(depth, position, false);
+  bulkCounting    = bulk;
+  return stopFlag ? 0 : nodes;
+}
+
+void Perft::setHashSize(std::size_t sizeInMB) {
+  hash = sizeInMB ? std::make_shared<PerftHash>(sizeInMB) : nullptr;
+}
+
 void Perft::perft(int startDepth, int endDepth, bool onDemand) {
   stopFlag = false;
+  depthResults.clear();
   for (int depth = startDepth; depth <= endDepth; ++depth) {
     if (stopFlag) {
       std::cout << "Perft stopped.";
@@ -50,6 +118,18 @@ void Perft::perft(int startDepth, int endDepth, bool onDemand) {
     }
     perft(depth, onDemand);
   }
+
+  // summary with the nodes per second of each depth
+  std::ostringstream os;
+  os.imbue(deLocale);
+  os << "Depth         Nodes       Time (ms)            NPS" << std::endl;
+  for (const DepthResult& r : depthResults) {
+    os << std::setw(5) << r.depth
+       << std::setw(19) << r.nodes
+       << std::setw(12) << r.durationMs
+       << std::setw(19) << (r.nodes * 1'000) / (r.durationMs + 1) << std::endl;
+  }
+  std::cout << os.str() << std::endl;
 }
 
 void Perft::perft(int maxDepth, bool onDemand) {
@@ -63,7 +143,6 @@ void Perft::perft(int maxDepth, bool onDemand) {
     std::cerr << fmt::format("Fen for perft invalid: {}", e.what()) << std::endl;
     return;
   }
-  MoveGenerator mg[MAX_DEPTH];
   std::ostringstream os;
   std::cout.imbue(deLocale);
   os.imbue(deLocale);
@@ -71,6 +150,7 @@ void Perft::perft(int maxDepth, bool onDemand) {
 
   os << "Performing PERFT Test for Depth " << maxDepth << std::endl;
   os << "FEN: " << fen << std::endl;
+  os << "Threads: " << threads << " Hash: " << (hash && bulkCounting ? hash->size() : 0) << " entries" << std::endl;
   os << "-----------------------------------------" << std::endl;
 
   std::cout << os.str();
@@ -78,15 +158,11 @@ void Perft::perft(int maxDepth, bool onDemand) {
   os.str("");
   os.clear();
 
-  uint64_t result;
   auto start = std::chrono::high_resolution_clock::now();
 
-  if (onDemand) {
-    result = miniMaxOD(maxDepth, position, mg);
-  }
-  else {
-    result = miniMax(maxDepth, position, mg);
-  }
+  const uint64_t result = threads > 1 && maxDepth > 1
+                            ? countParallel(maxDepth, position, onDemand)
+                            : count(maxDepth, position, onDemand);
 
   if (stopFlag) {
     std::cout << "Perft stopped.";
@@ -97,11 +173,19 @@ void Perft::perft(int maxDepth, bool onDemand) {
   uint64_t duration = std::chrono::duration_cast<std::chrono::milliseconds>(finish - start).count();
 
   nodes = result;
+  depthResults.push_back({maxDepth, nodes, duration});
 
   os << "Time         : " << duration << " ms" << std::endl;
   os << "NPS          : " << (result * 1'000) / (duration + 1) << " nps" << std::endl;
   os << "Results:" << std::endl;
   os << "   Nodes     : " << nodes << std::endl;
+  if (bulkCounting) {
+    os << "   (bulk counting - no captures, checks, etc.)" << std::endl;
+    os << "-----------------------------------------" << std::endl;
+    os << "Finished PERFT Test for Depth " << maxDepth << std::endl;
+    std::cout << os.str() << std::endl;
+    return;
+  }
   os << "   Captures  : " << captureCounter << std::endl;
   os << "   EnPassant : " << enpassantCounter << std::endl;
   os << "   Checks    : " << checkCounter << std::endl;
@@ -114,6 +198,60 @@ void Perft::perft(int maxDepth, bool onDemand) {
   std::cout << os.str() << std::endl;
 }
 
+uint64_t Perft::count(int depth, Position& position, bool onDemand) {
+  if (bulkCounting) {
+    return miniMaxBulk(depth, position);
+  }
+  std::vector<MoveGenerator> mg(MAX_DEPTH);
+  if (legalMoveGen) {
+    return miniMaxLegal(depth, position, mg.data());
+  }
+  if (onDemand) {
+    return miniMaxOD(depth, position, mg.data());
+  }
+  return miniMax(depth, position, mg.data());
+}
+
+uint64_t Perft::countParallel(int depth, Position& position, bool onDemand) {
+  // Each root move is counted as a task by its own worker with its own
+  // counters, position and move generators. The workers share the hash
+  // and stop when this perft is stopped.
+  MoveList rootMoves;
+  generateLegalMoves(position, rootMoves);
+
+  std::vector<std::unique_ptr<Perft>> workers{};
+  std::vector<std::future<uint64_t>> results{};
+  {
+    ThreadPool pool{static_cast<std::size_t>(threads)};
+    for (Move move : rootMoves) {
+      auto worker          = std::make_unique<Perft>(fen);
+      worker->legalMoveGen = legalMoveGen;
+      worker->bulkCounting = bulkCounting;
+      worker->hash         = hash;
+      worker->stopSignal   = &stopFlag;
+      Perft* w             = worker.get();
+      workers.push_back(std::move(worker));
+      results.push_back(pool.enqueue([w, move, depth, onDemand, position] {
+        Position p = position;
+        p.doMove(move);
+        return w->count(depth - 1, p, onDemand);
+      }));
+    }
+  }// the pool finishes all tasks before it is destroyed
+
+  uint64_t totalNodes = 0;
+  for (auto& result : results) totalNodes += result.get();
+  for (const auto& w : workers) {
+    checkCounter += w->checkCounter;
+    checkMateCounter += w->checkMateCounter;
+    captureCounter += w->captureCounter;
+    enpassantCounter += w->enpassantCounter;
+    castleCounter += w->castleCounter;
+    promotionCounter += w->promotionCounter;
+  }
+  return totalNodes;
+}
+
 uint64_t Perft::miniMaxOD(int depth, Position& position, MoveGenerator* pMg) {
   pMg[depth].reset();
 
@@ -122,7 +260,7 @@ uint64_t Perft::miniMaxOD(int depth, Position& position, MoveGenerator* pMg) {
 
   // moves to search recursively
   Move move;
-  while (!stopFlag) {
+  while (!stopped()) {
     move = pMg[depth].getNextPseudoLegalMove(position, GenAll);
     if (move == MOVE_NONE) break;
     //    fprintln("Last: {:5s} Move: {:5s}   Fen: {:s} ", str(position.getLastMove()), str(move), position.strFen());
@@ -180,7 +318,7 @@ uint64_t Perft::miniMax(int depth, Position& position, MoveGenerator* pMg) {
   // moves to search recursively
   MoveList moves = *pMg[depth].generatePseudoLegalMoves(position, GenAll);
   for (Move move : moves) {
-    if (stopFlag) {
+    if (stopped()) {
       return 0;
     }
     if (depth > 1) {
@@ -225,6 +363,80 @@ uint64_t Perft::miniMax(int depth, Position& position, MoveGenerator* pMg) {
   return totalNodes;
 }
 
+uint64_t Perft::miniMaxLegal(int depth, Position& position, MoveGenerator* pMg) {
+
+  // Iterate over moves
+  uint64_t totalNodes = 0;
+
+  // all generated moves are legal - no need to test them after doMove
+  const MoveList* moves = pMg[depth].generateLegalMoves(position, GenAll);
+  for (Move move : *moves) {
+    if (stopped()) {
+      return 0;
+    }
+    position.doMove(move);
+    if (depth > 1) {
+      totalNodes += miniMaxLegal(depth - 1, position, pMg);
+    }
+    else {
+      totalNodes++;
+      // enpassant
+      if (typeOf(move) == ENPASSANT) {
+        enpassantCounter++;
+        captureCounter++;
+      }
+      // castling
+      else if (typeOf(move) == CASTLING) {
+        castleCounter++;
+      }
+      else if (typeOf(move) == PROMOTION) {
+        promotionCounter++;
+      }
+      // capture
+      if (position.getLastCapturedPiece() != PIECE_NONE) {
+        captureCounter++;
+      }
+      // check
+      if (position.hasCheck()) {
+        checkCounter++;
+        //  mate
+        if (!MoveGenerator::hasLegalMove(position)) {
+          checkMateCounter++;
+        }
+      }
+    }
+    position.undoMove();
+  }
+  return totalNodes;
+}
+
+uint64_t Perft::miniMaxBulk(int depth, Position& position) {
+  // transposed sub trees are only counted once
+  uint64_t totalNodes = 0;
+  if (hash && depth > 1 && hash->probe(position.getZobristKey(), depth, totalNodes)) {
+    return totalNodes;
+  }
+
+  MoveList moves;
+  generateLegalMoves(position, moves);
+
+  // the legal moves of the last ply are the leaf nodes
+  if (depth <= 1) {
+    return moves.size();
+  }
+
+  for (Move move : moves) {
+    if (stopped()) {
+      return 0;
+    }
+    position.doMove(move);
+    totalNodes += miniMaxBulk(depth - 1, position);
+    position.undoMove();
+  }
+  if (hash && !stopped()) hash->store(position.getZobristKey(), depth, totalNodes);
+  return totalNodes;
+}
+
 void Perft::perft_divide(int maxDepth, bool onDemand) {
   resetCounter();
 
@@ -21,7 +21,11 @@
 #define FRANKYCPP_PERFT_H
 
 // included dependencies
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <string>
+#include <vector>
 #include "types/types.h"
 
 // forward declared dependencies
@@ -30,6 +34,24 @@ class MoveGenerator;
 
 class Perft {
 
+  // Lock free hash for node counts of sub trees keyed by zobrist key and
+  // depth. Each entry stores the key XOR the node count next to the node
+  // count so a torn write by another thread is detected as a miss.
+  class PerftHash {
+    struct Entry {
+      std::atomic<uint64_t> check{0};
+      std::atomic<uint64_t> nodes{0};
+    };
+    std::unique_ptr<Entry[]> entries;
+    uint64_t mask = 0;
+
+  public:
+    explicit PerftHash(std::size_t sizeInMB);
+    bool probe(Key key, int depth, uint64_t& nodes) const;
+    void store(Key key, int depth, uint64_t nodes);
+    [[nodiscard]] std::size_t size() const { return mask + 1; }
+  };
+
   uint64_t nodes{};
   uint64_t checkCounter{};
   uint64_t checkMateCounter{};
@@ -38,7 +60,22 @@ class Perft {
   uint64_t castleCounter{};
   uint64_t promotionCounter{};
   std::string fen;
-  bool stopFlag{};
+  std::atomic_bool stopFlag{};
+  bool legalMoveGen{};
+  bool bulkCounting{};
+
+  // parallel perft - workers observe the stop flag of the main perft
+  int threads = 1;
+  std::shared_ptr<PerftHash> hash{};
+  const std::atomic_bool* stopSignal = &stopFlag;
+
+  // per depth results of the last perft(startDepth, endDepth, onDemand)
+  struct DepthResult {
+    int depth;
+    uint64_t nodes;
+    uint64_t durationMs;
+  };
+  std::vector<DepthResult> depthResults{};
 
 public:
   Perft();
@@ -51,6 +88,29 @@ public:
 
   void stop();
 
+  // Counts the leaf nodes of the given depth with bulk counting and the
+  // current thread and hash settings without printing anything.
+  // Returns 0 if the fen is invalid or the perft has been stopped.
+  uint64_t countNodes(int depth);
+
+  // use the legal move generator (pin and checker masks) instead of
+  // generating pseudo legal moves and testing them after doMove
+  void setLegalMoveGen(bool legal) { legalMoveGen = legal; }
+
+  // count the legal moves at the last ply instead of making each of them.
+  // Much faster but only the number of nodes is counted - captures, checks,
+  // etc. need the detailed (non bulk) mode.
+  void setBulkCounting(bool bulk) { bulkCounting = bulk; }
+
+  // number of threads - the moves of the root position are searched in
+  // parallel on a ThreadPool
+  void setThreads(int numberOfThreads) { threads = std::max(1, numberOfThreads); }
+
+  // size of the perft hash in MB (0 = no hash). Transposed sub trees are
+  // only counted once. Only used with bulk counting as the hash stores
+  // node counts only.
+  void setHashSize(std::size_t sizeInMB);
+
   uint64_t getNodes() const { return nodes; }
   uint64_t getCaptureCounter() const { return captureCounter; }
   uint64_t getEnpassantCounter() const { return enpassantCounter; }
@@ -61,8 +121,13 @@ public:
 
 private:
   void resetCounter();
+  [[nodiscard]] bool stopped() const { return stopSignal->load(std::memory_order_relaxed); }
+  uint64_t count(int depth, Position &position, bool onDemand);
+  uint64_t countParallel(int depth, Position &position, bool onDemand);
   uint64_t miniMax(int depth, Position &position, MoveGenerator *moveGeneratorList);
   uint64_t miniMaxOD(int depth, Position &position, MoveGenerator *moveGeneratorList);
+  uint64_t miniMaxLegal(int depth, Position &position, MoveGenerator *moveGeneratorList);
+  uint64_t miniMaxBulk(int depth, Position &position);
 };
 
 
@@ -83,21 +83,20 @@ void Position::doMove(Move move) {
   assert(validSquare(toSquare(move)));
   assert(getPiece(fromSquare(move)) != PIECE_NONE);
   assert(colorOf(getPiece(fromSquare(move))) == nextPlayer);
-  assert((historyCounter < MAX_MOVES - 1) && "Can't have more move than MAX_MOVES");
 
   const Square fromSq = fromSquare(move);
   const Square toSq   = toSquare(move);
 
   // Save state of board for undo
-  historyState[historyCounter++] = {zobristKey,
-                                    pawnKey,
-                                    move,
-                                    board[fromSq],
-                                    board[toSq],
-                                    castlingRights,
-                                    enPassantSquare,
-                                    halfMoveClock,
-                                    hasCheckFlag};
+  historyState.push({zobristKey,
+                     pawnKey,
+                     move,
+                     board[fromSq],
+                     board[toSq],
+                     castlingRights,
+                     enPassantSquare,
+                     halfMoveClock,
+                     hasCheckFlag});
 
   // change the position data according to the move
   switch (typeOf(move)) {
@@ -235,14 +234,13 @@ void Position::doMove(Move move) {
 }
 
 void Position::undoMove() {
-  assert(historyCounter > 0);
+  assert(!historyState.empty());
 
   // Restore state part 1
-  historyCounter--;
   if (nextPlayer == WHITE) moveNumber--;
   nextPlayer = ~nextPlayer;
 
-  const HistoryState& lastHistoryState = historyState[historyCounter];
+  const HistoryState& lastHistoryState = historyState.back();
   const Move move                      = lastHistoryState.move;
 
   // undo piece move / restore board
@@ -299,21 +297,22 @@ void Position::undoMove() {
   zobristKey      = lastHistoryState.zobristKey;
   pawnKey         = lastHistoryState.pawnKey;
   hasCheckFlag    = lastHistoryState.hasCheckFlag;
+  historyState.pop();
 }
 
 void Position::doNullMove() {
   // Save state of board for undo
   // update existing history entry to not create and allocate a new one
   // Save state of board for undo
-  historyState[historyCounter++] = {zobristKey,
-                                    pawnKey,
-                                    MOVE_NONE,
-                                    PIECE_NONE,
-                                    PIECE_NONE,
-                                    castlingRights,
-                                    enPassantSquare,
-                                    halfMoveClock,
-                                    hasCheckFlag};
+  historyState.push({zobristKey,
+                     pawnKey,
+                     MOVE_NONE,
+                     PIECE_NONE,
+                     PIECE_NONE,
+                     castlingRights,
+                     enPassantSquare,
+                     halfMoveClock,
+                     hasCheckFlag});
   // update state for null move
   hasCheckFlag = FLAG_TBD;
   clearEnPassant();
@@ -324,16 +323,16 @@ void Position::doNullMove() {
 
 void Position::undoNullMove() {
   // Restore state
-  historyCounter--;
   if (nextPlayer == WHITE) moveNumber--;
   nextPlayer                           = ~nextPlayer;
-  const HistoryState& lastHistoryState = historyState[historyCounter];
+  const HistoryState& lastHistoryState = historyState.back();
   castlingRights                       = lastHistoryState.castlingRights;
   enPassantSquare                      = lastHistoryState.enPassantSquare;
   halfMoveClock                        = lastHistoryState.halfMoveClock;
   hasCheckFlag                         = lastHistoryState.hasCheckFlag;
   pawnKey                              = lastHistoryState.pawnKey;
   zobristKey                           = lastHistoryState.zobristKey;
+  historyState.pop();
 }
 
 bool Position::isAttacked(Square sq, Color by) const {
@@ -523,8 +522,8 @@ bool Position::wasLegalMove() const {
   // king attacked?
   if (isAttacked(kingSquare[~nextPlayer], nextPlayer)) return false;
   // look back and check if castling was legal
-  if (historyCounter > 0) {
-    const Move lastMove = historyState[historyCounter - 1].move;
+  if (!historyState.empty()) {
+    const Move lastMove = historyState.back().move;
     if (typeOf(lastMove) == CASTLING) {
       // no castling when in check
       if (isAttacked(fromSquare(lastMove), nextPlayer)) {
@@ -552,6 +551,61 @@ bool Position::wasLegalMove() const {
   return true;
 }
 
+bool Position::isPseudoLegalMove(Move move) const {
+  if (!validMove(move)) return false;
+  const Square from = fromSquare(move);
+  const Square to   = toSquare(move);
+  const Piece piece = board[from];
+
+  // we need to move one of our own pieces to a square not occupied by us
+  if (piece == PIECE_NONE || colorOf(piece) != nextPlayer) return false;
+  if (occupiedBb[nextPlayer] & to) return false;
+
+  const PieceType pieceType = typeOf(piece);
+  const Bitboard occupied   = getOccupiedBb();
+  const Rank promotionRank  = nextPlayer == WHITE ? RANK_8 : RANK_1;
+
+  switch (typeOf(move)) {
+    case CASTLING:
+      // same conditions as in the move generator
+      if (pieceType != KING) return false;
+      switch (to) {
+        case SQ_G1:
+          return from == SQ_E1 && castlingRights == WHITE_OO && !(Bitboards::intermediateBb[SQ_E1][SQ_H1] & occupied);
+        case SQ_C1:
+          return from == SQ_E1 && castlingRights == WHITE_OOO && !(Bitboards::intermediateBb[SQ_E1][SQ_A1] & occupied);
+        case SQ_G8:
+          return from == SQ_E8 && castlingRights == BLACK_OO && !(Bitboards::intermediateBb[SQ_E8][SQ_H8] & occupied);
+        case SQ_C8:
+          return from == SQ_E8 && castlingRights == BLACK_OOO && !(Bitboards::intermediateBb[SQ_E8][SQ_A8] & occupied);
+        default:
+          return false;
+      }
+    case ENPASSANT:
+      return pieceType == PAWN && to == enPassantSquare && (Bitboards::pawnAttacks[nextPlayer][from] & to);
+    case PROMOTION:
+      if (pieceType != PAWN || rankOf(to) != promotionRank) return false;
+      break;
+    default:
+      // pawn moves to the last rank must be promotions
+      if (pieceType == PAWN && rankOf(to) == promotionRank) return false;
+      break;
+  }
+
+  if (pieceType == PAWN) {
+    // captures
+    if (Bitboards::pawnAttacks[nextPlayer][from] & to) return occupiedBb[~nextPlayer] & to;
+    // single push
+    const Square push = pawnPush(from, nextPlayer);
+    if (to == push) return !(occupied & to);
+    // double push from the start rank
+    const Rank startRank = nextPlayer == WHITE ? RANK_2 : RANK_7;
+    return rankOf(from) == startRank && to == pawnPush(push, nextPlayer) && !(occupied & push) && !(occupied & to);
+  }
+
+  return getAttacksBb(pieceType, from, occupied) & to;
+}
+
 bool Position::isLegalMove(Move move) const {
   // king is not allowed to pass a square which is attacked by opponent
   if (typeOf(move) == CASTLING) {
@@ -593,6 +647,55 @@ bool Position::isLegalMove(Move move) const {
   return legal;
 }
 
+Bitboard Position::pinnedPieces(Color color) const {
+  const Square ourKing     = kingSquare[color];
+  const Bitboard occupied  = getOccupiedBb();
+  // opponent sliders which would attack the king on an empty board
+  Bitboard snipers = (getAttacksBb(ROOK, ourKing, BbZero) & (piecesBb[~color][ROOK] | piecesBb[~color][QUEEN]))
+                     | (getAttacksBb(BISHOP, ourKing, BbZero) & (piecesBb[~color][BISHOP] | piecesBb[~color][QUEEN]));
+  Bitboard pinned = BbZero;
+  while (snipers) {
+    const Square sniper     = popLSB(snipers);
+    const Bitboard blockers = Bitboards::intermediateBb[ourKing][sniper] & occupied;
+    // a single own piece between king and sniper is pinned
+    if (popcount(blockers) == 1 && (blockers & occupiedBb[color])) {
+      pinned |= blockers;
+    }
+  }
+  return pinned;
+}
+
+bool Position::isLegalMove(Move move, Bitboard pinned) const {
+  const MoveType type = typeOf(move);
+  if (type == ENPASSANT || type == CASTLING) return isLegalMove(move);
+
+  const Color us      = nextPlayer;
+  const Color them    = ~us;
+  const Square from   = fromSquare(move);
+  const Square to     = toSquare(move);
+  const Square ourKing = kingSquare[us];
+
+  // the king must not move to an attacked square - sliders are looked up
+  // without the king on the board so the king can't step back along the
+  // line of a checking slider
+  if (from == ourKing) {
+    const Bitboard occupied = getOccupiedBb() ^ Bitboards::sqBb[from];
+    return !((Bitboards::pawnAttacks[us][to] & piecesBb[them][PAWN])
+             || (getAttacksBb(KNIGHT, to, BbZero) & piecesBb[them][KNIGHT])
+             || (getAttacksBb(KING, to, BbZero) & piecesBb[them][KING])
+             || (getAttacksBb(ROOK, to, occupied) & (piecesBb[them][ROOK] | piecesBb[them][QUEEN]))
+             || (getAttacksBb(BISHOP, to, occupied) & (piecesBb[them][BISHOP] | piecesBb[them][QUEEN])));
+  }
+
+  // pinned pieces may only move on the line between king and pinner - either
+  // towards the king or away from the king up to and including the pinner
+  if (pinned & Bitboards::sqBb[from]) {
+    return (Bitboards::intermediateBb[ourKing][from] & Bitboards::sqBb[to])
+           || (Bitboards::intermediateBb[ourKing][to] & Bitboards::sqBb[from]);
+  }
+  return true;
+}
+
 bool Position::checkRepetitions(int reps) const {
   /*
    [0]     3185849660387886977 << 1st
@@ -606,7 +709,7 @@ bool Position::checkRepetitions(int reps) const {
    [8]     3185849660387886977 <<< 3rd REPETITION from current zobrist
     */
   int counter      = 0;
-  int i            = historyCounter - 2;
+  int i            = historyState.size() - 2;
   int lastHalfMove = halfMoveClock;
   while (i >= 0) {
     // every time the half move clock gets reset (non reversible position) there
@@ -630,7 +733,7 @@ bool Position::checkRepetitions(int reps) const {
 
 int Position::countRepetitions() const {
   int counter      = 0;
-  int i            = historyCounter - 2;
+  int i            = historyState.size() - 2;
   int lastHalfMove = halfMoveClock;
   while (i >= 0) {
     // every time the half move clock gets reset (non reversible position) there
@@ -902,13 +1005,13 @@ inline void Position::clearEnPassant() {
 
 void Position::initializeBoard() {
 
-  std::fill_n(&board[0], sizeof(board), PIECE_NONE);
+  std::fill_n(&board[0], SQ_LENGTH, PIECE_NONE);
 
   castlingRights  = NO_CASTLING;
   enPassantSquare = SQ_NONE;
   halfMoveClock   = 0;
 
-  historyState.fill(HistoryState());
+  historyState.clear();
 
   nextPlayer = WHITE;
 
@@ -916,7 +1019,7 @@ void Position::initializeBoard() {
 
   for (Color color = WHITE; color <= BLACK; ++color) {// foreach color
     occupiedBb[color] = BbZero;
-    std::fill_n(&piecesBb[color][0], sizeof(piecesBb[color]), BbZero);
+    std::fill_n(&piecesBb[color][0], PT_LENGTH, BbZero);
     kingSquare[color]      = SQ_NONE;
     material[color]        = 0;
     materialNonPawn[color] = 0;
@@ -26,6 +26,7 @@
 
 #include <array>
 #include <cstdint>
+#include <vector>
 
 namespace Zobrist {
   // zobrist key for pieces - piece, board
@@ -57,6 +58,47 @@ struct HistoryState {
   Flag hasCheckFlag             = FLAG_TBD;
 };
 
+// HistoryStack holds the history states of a position - the game history
+// plus the moves made during search. It is owned separately from the
+// compact board state (on the heap) and grows as needed.
+// A copy only copies the used part of the history but reserves room
+// for a full search line (MAX_DEPTH moves) on top. A search working
+// on a copy therefore does not need to allocate in doMove.
+class HistoryStack {
+  std::vector<HistoryState> states{};
+
+public:
+  HistoryStack() { states.reserve(MAX_DEPTH); }
+
+  HistoryStack(const HistoryStack& other) {
+    states.reserve(other.states.size() + MAX_DEPTH);
+    states.assign(other.states.begin(), other.states.end());
+  }
+
+  HistoryStack& operator=(const HistoryStack& other) {
+    if (this != &other) {
+      states.reserve(other.states.size() + MAX_DEPTH);
+      states.assign(other.states.begin(), other.states.end());
+    }
+    return *this;
+  }
+
+  HistoryStack(HistoryStack&& other) noexcept = default;
+  HistoryStack& operator=(HistoryStack&& other) noexcept = default;
+  ~HistoryStack()                                        = default;
+
+  inline void push(const HistoryState& state) { states.push_back(state); }
+  inline void pop() { states.pop_back(); }
+  inline void clear() { states.clear(); }
+
+  inline const HistoryState& back() const { return states.back(); }
+  inline const HistoryState& operator[](const int i) const { return states[i]; }
+
+  inline int size() const { return static_cast<int>(states.size()); }
+  inline bool empty() const { return states.empty(); }
+  inline std::size_t capacity() const { return states.capacity(); }
+};
+
 // This class represents a chess position.<br>
 // It uses a 8x8 piece board and bitboards, a stack for undo moves, zobrist keys
 // for transposition tables, piece lists, material and positional value counter.
@@ -108,9 +150,8 @@ class Position {
   // **********************************************************
 
   // history information for undo and repetition detection
-  constexpr static std::size_t MAX_HISTORY = MAX_MOVES;
-  std::array<HistoryState, MAX_HISTORY> historyState{};
-  int historyCounter                       = 0;
+  // kept outside of the object so copies of a position stay small
+  HistoryStack historyState{};
 
   // Calculated by doMove/undoMove
 
@@ -240,6 +281,28 @@ public:
   // or if the king crosses an attacked square during castling.
   bool isLegalMove(Move move) const;
 
+  // PinnedPieces returns all pieces of the given color which are pinned to
+  // their own king by a sliding piece of the opponent.
+  Bitboard pinnedPieces(Color color) const;
+
+  // IsLegalMove tests a pseudo legal move of the next player for legality
+  // without making the move. Uses the pinned pieces of the next player
+  // (see pinnedPieces()) which only need to be computed once per position.
+  // King moves are tested for attacks to the target square as if the king
+  // had already left its square. En passant and castling moves are rare
+  // and fall back to isLegalMove(move).
+  // The move must be pseudo legal and if the position has check it must be
+  // an evasion (capture or block the single checker or a king move) as
+  // generated by the move generator in evasion mode.
+  bool isLegalMove(Move move, Bitboard pinned) const;
+
+  // IsPseudoLegalMove tests if a move could have been generated by a
+  // pseudo legal move generator on the current position without generating
+  // any moves. Used to verify moves from unreliable sources like a
+  // transposition table with reduced key bits. Does not check if the move
+  // leaves the king in check.
+  bool isPseudoLegalMove(Move move) const;
+
   // CheckRepetitions
   // Repetition of a position:.
   // To detect a 3-fold repetition the given position must occur at least 2
@@ -263,8 +326,8 @@ public:
 
   // Returns the last move. Returns Move.NOMOVE if there is no last move.
   inline Move getLastMove() const {
-    if (historyCounter <= 0) return MOVE_NONE;
-    return historyState[historyCounter - 1].move;
+    if (historyState.empty()) return MOVE_NONE;
+    return historyState.back().move;
   };
 
   /**
@@ -281,8 +344,8 @@ public:
   // non-capturing or the position has no history of earlier moves.
   // Does not return a pawn captured by en passant.
   inline Piece getLastCapturedPiece() const {
-    if (historyCounter <= 0) return PIECE_NONE;
-    return historyState[historyCounter - 1].capturedPiece;
+    if (historyState.empty()) return PIECE_NONE;
+    return historyState.back().capturedPiece;
   };
 
 private:
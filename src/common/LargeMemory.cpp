@@ -0,0 +1,212 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <new>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "LargeMemory.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+  // base page size of the OS or 0 if unknown
+  std::size_t osPageSize() {
+#ifdef __linux__
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+  }
+
+#ifdef __linux__
+  // size of transparent huge pages or 0 if they are disabled
+  std::size_t transparentHugePageSize() {
+    std::ifstream enabled("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string mode;
+    if (!std::getline(enabled, mode) || mode.find("[never]") != std::string::npos) return 0;
+    std::ifstream pmdSize("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+    std::size_t size = 0;
+    if (!(pmdSize >> size)) size = 2 * 1024 * 1024;
+    return size;
+  }
+
+  // default size of explicit (hugetlbfs) huge pages or 0 if unknown
+  // these are reserved separately from transparent huge pages
+  std::size_t explicitHugePageSize() {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    while (std::getline(meminfo, line)) {
+      std::size_t kb = 0;
+      if (std::sscanf(line.c_str(), "Hugepagesize: %zu kB", &kb) == 1) return kb * 1024;
+    }
+    return 0;
+  }
+
+  // interleaves the pages of the given mapping over all NUMA nodes
+  // this must be done before any page has been touched
+  bool interleavePages(void* addr, std::size_t len) {
+    // nodes which are not available to the process are ignored by the kernel
+    const unsigned long nodeMask = ~0UL;
+    return syscall(SYS_mbind, addr, len, MPOL_INTERLEAVE, &nodeMask, sizeof(nodeMask) * 8, 0) == 0;
+  }
+#endif
+}// namespace
+
+void* LargeMemory::allocate(std::size_t bytes, bool largePages, bool interleave) {
+  release();
+  if (!bytes) return nullptr;
+
+#ifdef __linux__
+  const std::size_t basePageSize = osPageSize();
+
+  // explicit huge pages - only available if reserved by the admin
+  const std::size_t hugetlbPageSize = largePages ? explicitHugePageSize() : 0;
+  if (hugetlbPageSize) {
+    const std::size_t len = ((bytes + hugetlbPageSize - 1) / hugetlbPageSize) * hugetlbPageSize;
+    void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+      mem      = p;
+      size     = len;
+      pageSize = hugetlbPageSize;
+    }
+  }
+
+  // regular mapping - with transparent huge pages if possible
+  if (!mem) {
+    const std::size_t thpSize   = largePages ? transparentHugePageSize() : 0;
+    const std::size_t alignment = thpSize ? thpSize : basePageSize;
+    const std::size_t len       = ((bytes + alignment - 1) / alignment) * alignment;
+    // the kernel can only use huge pages for huge page aligned ranges so the
+    // mapping is over allocated and trimmed to an aligned start address
+    const std::size_t mapLen = len + alignment - basePageSize;
+    void* p = mmap(nullptr, mapLen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p != MAP_FAILED) {
+      const auto start   = reinterpret_cast<uintptr_t>(p);
+      const auto aligned = ((start + alignment - 1) / alignment) * alignment;
+      if (aligned > start) munmap(p, aligned - start);
+      if (start + mapLen > aligned + len) munmap(reinterpret_cast<void*>(aligned + len), start + mapLen - aligned - len);
+      mem      = reinterpret_cast<void*>(aligned);
+      size     = len;
+      pageSize = basePageSize;
+      // madvise succeeds even if the kernel later backs the range with
+      // base pages so this is only recorded as a request
+      hugePagesAdvised = thpSize && madvise(mem, len, MADV_HUGEPAGE) == 0;
+    }
+  }
+
+  if (mem) {
+    mapped      = true;
+    interleaved = interleave && interleavePages(mem, size);
+    return mem;
+  }
+#else
+  (void) largePages;
+  (void) interleave;
+#endif
+
+  // fallback to heap memory
+  size     = ((bytes + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+  mem      = ::operator new(size, std::align_val_t(ALIGNMENT));
+  pageSize = osPageSize();
+  return mem;
+}
+
+void* LargeMemory::mapFile(const std::string& path, std::size_t bytes) {
+  release();
+  if (!bytes) return nullptr;
+
+#ifdef __linux__
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+  struct stat fileStat {};
+  if (fstat(fd, &fileStat) != 0 || static_cast<std::size_t>(fileStat.st_size) < bytes) {
+    close(fd);
+    return nullptr;
+  }
+  void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);// the mapping keeps its own reference to the file
+  if (p == MAP_FAILED) return nullptr;
+  mem      = p;
+  size     = bytes;
+  pageSize = osPageSize();
+  mapped   = true;
+  return mem;
+#else
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return nullptr;
+  size     = ((bytes + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+  mem      = ::operator new(size, std::align_val_t(ALIGNMENT));
+  pageSize = osPageSize();
+  if (!file.read(static_cast<char*>(mem), static_cast<std::streamsize>(bytes))) {
+    release();
+    return nullptr;
+  }
+  return mem;
+#endif
+}
+
+void LargeMemory::release() {
+  if (!mem) return;
+#ifdef __linux__
+  if (mapped) {
+    munmap(mem, size);
+  }
+  else {
+    ::operator delete(mem, std::align_val_t(ALIGNMENT));
+  }
+#else
+  ::operator delete(mem, std::align_val_t(ALIGNMENT));
+#endif
+  mem              = nullptr;
+  size             = 0;
+  pageSize         = 0;
+  mapped           = false;
+  interleaved      = false;
+  hugePagesAdvised = false;
+}
+
+void LargeMemory::swap(LargeMemory& other) noexcept {
+  std::swap(mem, other.mem);
+  std::swap(size, other.size);
+  std::swap(pageSize, other.pageSize);
+  std::swap(mapped, other.mapped);
+  std::swap(interleaved, other.interleaved);
+  std::swap(hugePagesAdvised, other.hugePagesAdvised);
+}
+
+std::string LargeMemory::str() const {
+  if (!mem) return "no memory";
+  const std::string page = !pageSize                 ? std::string("unknown page size")
+                           : pageSize >= 1024 * 1024 ? fmt::format("{} MB pages", pageSize / (1024 * 1024))
+                                                     : fmt::format("{} KB pages", pageSize / 1024);
+  return fmt::format("{}{}, {}{}", page, hugePagesAdvised ? " (THP requested)" : "", mapped ? "mmap" : "heap",
+                     interleaved ? ", interleaved" : "");
+}
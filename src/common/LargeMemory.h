@@ -0,0 +1,115 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef FRANKYCPP_LARGEMEMORY_H
+#define FRANKYCPP_LARGEMEMORY_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Memory block for large hash tables (TT, PawnTT).
+ *
+ * On Linux the memory is mapped with mmap. If large pages are requested
+ * explicit huge pages (MAP_HUGETLB) are tried first and then the kernel
+ * is advised to back the mapping with transparent huge pages
+ * (MADV_HUGEPAGE) on a huge page aligned mapping. Huge pages avoid a TLB miss on nearly every random
+ * access into a large table. Mapped memory is not touched when allocated
+ * so physical pages are placed on the NUMA node of the thread which
+ * touches them first - e.g. the threads clearing a table - unless the
+ * pages are interleaved over all NUMA nodes.
+ *
+ * On other platforms or if mapping fails this falls back to cache line
+ * aligned heap memory with the OS default page size.
+ *
+ * A block can also be mapped from a file (copy on write) which allows
+ * to restore large tables without reading the whole file upfront.
+ */
+class LargeMemory {
+  void* mem             = nullptr;
+  std::size_t size      = 0;
+  std::size_t pageSize  = 0;
+  bool mapped           = false;
+  bool interleaved      = false;
+  bool hugePagesAdvised = false;
+
+public:
+  static constexpr std::size_t ALIGNMENT = 64;
+
+  LargeMemory() = default;
+
+  ~LargeMemory() { release(); }
+
+  // disallow copies
+  LargeMemory(LargeMemory const&) = delete;           // copy
+  LargeMemory& operator=(const LargeMemory&) = delete;// copy assignment
+  LargeMemory(LargeMemory const&&)           = delete;// move
+  LargeMemory& operator=(const LargeMemory&&) = delete;// move assignment
+
+  /**
+   * Releases any previously allocated memory and allocates a new block.
+   * The memory is aligned to at least ALIGNMENT bytes. It is not
+   * initialized - mapped memory is zero but untouched.
+   * @param bytes size of the memory block
+   * @param largePages try to use huge pages
+   * @param interleave interleave pages over all NUMA nodes instead of
+   *        placing them on the node of the first touching thread
+   * @return pointer to the memory or nullptr if bytes is 0
+   * @throws std::bad_alloc if no memory could be allocated
+   */
+  void* allocate(std::size_t bytes, bool largePages, bool interleave);
+
+  /**
+   * Releases any previously allocated memory and maps the first bytes of
+   * the given file privately (copy on write) - changes are never written
+   * back to the file. Pages are read lazily from the file when touched.
+   * Without mmap support the file content is read into heap memory.
+   * @param path file to map
+   * @param bytes number of bytes to map - the file must be at least this large
+   * @return pointer to the start of the file content or nullptr if the file
+   *         could not be mapped
+   */
+  void* mapFile(const std::string& path, std::size_t bytes);
+
+  /** Releases the memory block */
+  void release();
+
+  /** Exchanges the memory blocks of this and the other instance */
+  void swap(LargeMemory& other) noexcept;
+
+  /**
+   * Page size guaranteed to back the memory block. For transparent huge
+   * pages this is the base page size as the kernel might not grant them -
+   * see isHugePagesAdvised(). 0 if no memory is allocated or the page
+   * size of the OS is unknown (heap memory on other platforms than Linux).
+   */
+  std::size_t getPageSize() const { return pageSize; }
+
+  /** true if transparent huge pages were requested for the memory block */
+  bool isHugePagesAdvised() const { return hugePagesAdvised; }
+
+  bool isMapped() const { return mapped; }
+
+  bool isInterleaved() const { return interleaved; }
+
+  /** Returns a short description of the memory placement, e.g. "4 KB pages (THP requested), mmap" */
+  std::string str() const;
+};
+
+#endif//FRANKYCPP_LARGEMEMORY_H
@@ -17,6 +17,8 @@
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include "Logging.h"
 
@@ -26,10 +28,50 @@ namespace po = boost::program_options;
 
 inline po::variables_map programOptions{};
 
+bool Logger::asyncLogging() {
+  return programOptions.count("log_async") && programOptions["log_async"].as<bool>();
+}
+
+std::shared_ptr<spdlog::logger> Logger::createLogger(const std::string& name, bool async) {
+  if (!async) {
+    return spdlog::stdout_color_mt(name);
+  }
+
+  // all async loggers share one thread pool with one writer thread
+  if (!spdlog::thread_pool()) {
+    const auto queueSize = programOptions.count("log_queue_size") ? programOptions["log_queue_size"].as<int>() : 8'192;
+    spdlog::init_thread_pool(std::max(queueSize, 1), 1);
+  }
+
+  auto overflowPolicy = spdlog::async_overflow_policy::block;
+  if (programOptions.count("log_overflow")) {
+    const auto& overflow = programOptions["log_overflow"].as<std::string>();
+    if (overflow == "drop") {
+      overflowPolicy = spdlog::async_overflow_policy::overrun_oldest;
+    }
+    else if (overflow != "block") {
+      std::cerr << "unknown log overflow policy '" << overflow << "' - using block.\n";
+    }
+  }
+
+  auto logger = std::make_shared<spdlog::async_logger>(name, std::make_shared<spdlog::sinks::stdout_color_sink_mt>(),
+                                                       spdlog::thread_pool(), overflowPolicy);
+  spdlog::register_logger(logger);
+  return logger;
+}
+
 void Logger::init() {
 
   const auto flushLevel = spdlog::level::trace;
 
+  // flushing after every message would put a flush message into the queue
+  // for every log message of an async logger - these are flushed by the
+  // background thread periodically and on errors instead
+  const auto asyncFlushLevel = asyncLogging() ? spdlog::level::err : flushLevel;
+  if (asyncLogging()) {
+    spdlog::flush_every(std::chrono::seconds(1));
+  }
+
   auto logLvL = !programOptions.empty() ? programOptions["log_lvl"].as<std::string>() : "warn";
   auto searchLogLvL = !programOptions.empty() ? programOptions["search_log_lvl"].as<std::string>() : "warn";
 
@@ -106,7 +148,7 @@ void Logger::init() {
   SEARCH_LOG->sinks().push_back(sharedFileSink);
   SEARCH_LOG->set_pattern(defaultPattern);
   SEARCH_LOG->set_level(searchLogLevel);
-  SEARCH_LOG->flush_on(flushLevel);
+  SEARCH_LOG->flush_on(asyncFlushLevel);
 
   TSUITE_LOG->sinks().push_back(sharedFileSink);
   TSUITE_LOG->set_pattern(defaultPattern);
@@ -136,14 +178,14 @@ void Logger::init() {
   BOOK_LOG->sinks().push_back(sharedFileSink);
   BOOK_LOG->set_pattern(defaultPattern);
   BOOK_LOG->set_level(logLevel);
-  BOOK_LOG->flush_on(flushLevel);
+  BOOK_LOG->flush_on(asyncFlushLevel);
 
   // Logger for Unit Tests
   TEST_LOG->set_pattern(defaultPattern);
   TEST_LOG->set_level(logLevel);
   TEST_LOG->flush_on(flushLevel);
 
-  std::cout << "Logger initialized (" << logLvL << " / " << searchLogLvL << ")" << std::endl;
+  std::cout << "Logger initialized (" << logLvL << " / " << searchLogLvL << (asyncLogging() ? " / async" : "") << ")" << std::endl;
 }
 
 
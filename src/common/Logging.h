@@ -21,11 +21,15 @@
 #define FRANKYCPP_LOGGING_H
 
 #include <iosfwd>
+#include <iterator>
 
+#include "spdlog/async.h"
 #include "spdlog/sinks/basic_file_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include <spdlog/spdlog.h>
 
+#include "types/globals.h"
+
 #ifdef NDEBUG
 #define ASSERT_START while (0) {
 #define ASSERT_END }
@@ -44,40 +48,66 @@
 #define DEBUG__LVL 5
 #define TRACE__LVL 6
 
+// Compile time log level - LOG__ macros above this level are compiled out
+// completely. Can be set by the build (cmake -DLOG_LEVEL=<0-6>). Defaults to
+// info for release builds and to debug otherwise.
+#ifndef LOG__LEVEL
+#ifdef NDEBUG
+#define LOG__LEVEL INFO__LVL
+#else
 #define LOG__LEVEL DEBUG__LVL
+#endif
+#endif
+
+// Formats the log message with the german locale into a buffer on the stack
+// and hands it to the logger. Other than fmt::format this does not allocate
+// memory for messages of usual length which allows logging in the search.
+template<typename S, typename... Args>
+inline void logFormatted(const std::shared_ptr<spdlog::logger>& logger, spdlog::level::level_enum level, const S& format, Args&&... args) {
+  fmt::memory_buffer buffer;
+  fmt::format_to(std::back_inserter(buffer), deLocale, format, std::forward<Args>(args)...);
+  logger->log(level, spdlog::string_view_t(buffer.data(), buffer.size()));
+}
+
+// Checks the logger's level before the arguments are evaluated and the
+// message is formatted so a disabled level only costs the level check.
+#define LOG__AT(logger, level, ...)                                          \
+  do {                                                                       \
+    if ((logger)->should_log(level)) logFormatted(logger, level, __VA_ARGS__); \
+  } while (0)
 
 #if LOG__LEVEL > ZERO__LVL
-#define LOG__CRITICAL(logger, ...) logger->critical("{:s}", fmt::format(deLocale, __VA_ARGS__))
+#define LOG__CRITICAL(logger, ...) LOG__AT(logger, spdlog::level::critical, __VA_ARGS__)
 #else
 #define LOG__CRITICAL(logger, ...) void(0)
 #endif
 
 #if LOG__LEVEL > CRITICAL__LVL
-#define LOG__ERROR(logger, ...) logger->error("{:s}", fmt::format(deLocale, __VA_ARGS__))
+#define LOG__ERROR(logger, ...) LOG__AT(logger, spdlog::level::err, __VA_ARGS__)
 #else
 #define LOG__ERROR(logger, ...) void(0)
 #endif
 
 #if LOG__LEVEL > ERROR__LVL
-#define LOG__WARN(logger, ...) logger->warn("{:s}", fmt::format(deLocale, __VA_ARGS__))
+#define LOG__WARN(logger, ...) LOG__AT(logger, spdlog::level::warn, __VA_ARGS__)
 #else
 #define LOG__WARN(logger, ...) void(0)
 #endif
 
 #if LOG__LEVEL > WARN__LVL
-#define LOG__INFO(logger, ...) logger->info("{:s}", fmt::format(deLocale, __VA_ARGS__))
+#define LOG__INFO(logger, ...) LOG__AT(logger, spdlog::level::info, __VA_ARGS__)
 #else
 #define LOG__INFO(logger, ...) void(0)
 #endif
 
 #if LOG__LEVEL > INFO__LVL
-#define LOG__DEBUG(logger, ...) logger->debug("{:s}", fmt::format(deLocale, __VA_ARGS__))
+#define LOG__DEBUG(logger, ...) LOG__AT(logger, spdlog::level::debug, __VA_ARGS__)
 #else
 #define LOG__DEBUG(logger, ...) void(0)
 #endif
 
 #if LOG__LEVEL > DEBUG__LVL
-#define LOG__TRACE(logger, ...) logger->trace("{:s}", fmt::format(deLocale, __VA_ARGS__))
+#define LOG__TRACE(logger, ...) LOG__AT(logger, spdlog::level::trace, __VA_ARGS__)
 #else
 #define LOG__TRACE(logger, ...) void(0)
 #endif
@@ -101,6 +131,16 @@ public:
     return instance;
   }
 
+  // Creates a console logger. An async logger only copies the formatted
+  // message into the pre-allocated queue of spdlog's thread pool and a
+  // background thread writes it to the sinks. When the queue is full the
+  // configured overflow policy (log_overflow) either blocks the caller or
+  // drops the oldest queued message.
+  static std::shared_ptr<spdlog::logger> createLogger(const std::string& name, bool async);
+
+  // true if search and book logs should be written asynchronously (log_async)
+  static bool asyncLogging();
+
   const std::string defaultPattern = "[%H:%M:%S:%f] [t:%-10!t] [%-17n] [%-8l]: %v";
 
   const std::shared_ptr<spdlog::sinks::basic_file_sink_mt> sharedFileSink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("FrankyCPP.log");
@@ -111,9 +151,9 @@ public:
   const std::shared_ptr<spdlog::logger> TEST_LOG    = spdlog::stdout_color_mt("Test_Logger");
   const std::shared_ptr<spdlog::logger> UCIHAND_LOG = spdlog::stdout_color_mt("UCIHandler_Logger");
   const std::shared_ptr<spdlog::logger> UCI_LOG     = spdlog::basic_logger_mt("UCI_Logger", "FrankyCPP_uci.log");
-  const std::shared_ptr<spdlog::logger> BOOK_LOG    = spdlog::stdout_color_mt("Book_Logger");
+  const std::shared_ptr<spdlog::logger> BOOK_LOG    = createLogger("Book_Logger", asyncLogging());
   const std::shared_ptr<spdlog::logger> TT_LOG      = spdlog::stdout_color_mt("TT_Logger");
-  const std::shared_ptr<spdlog::logger> SEARCH_LOG  = spdlog::stdout_color_mt("Search_Logger");
+  const std::shared_ptr<spdlog::logger> SEARCH_LOG  = createLogger("Search_Logger", asyncLogging());
   const std::shared_ptr<spdlog::logger> EVAL_LOG    = spdlog::stdout_color_mt("Eval_Logger");
   const std::shared_ptr<spdlog::logger> TSUITE_LOG  = spdlog::stdout_color_mt("TSuite_Logger");
   // @formatter:on
@@ -0,0 +1,57 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "Worker.h"
+
+Worker::Worker(std::function<void()> job) : job(std::move(job)) {
+  thread = std::thread([this] {
+    std::unique_lock<std::mutex> lock{mutex};
+    while (true) {
+      condition.wait(lock, [this] { return stopping || requested; });
+      // a started job is run even if the worker is stopping
+      if (!requested) break;
+      lock.unlock();
+      this->job();
+      lock.lock();
+      requested = false;
+      condition.notify_all();
+    }
+  });
+}
+
+Worker::~Worker() {
+  {// lock block
+    std::lock_guard<std::mutex> lock{mutex};
+    stopping = true;
+  }
+  condition.notify_all();
+  thread.join();
+}
+
+void Worker::start() {
+  std::unique_lock<std::mutex> lock{mutex};
+  condition.wait(lock, [this] { return !requested; });
+  requested = true;
+  condition.notify_all();
+}
+
+void Worker::wait() {
+  std::unique_lock<std::mutex> lock{mutex};
+  condition.wait(lock, [this] { return !requested; });
+}
@@ -0,0 +1,64 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef FRANKYCPP_WORKER_H
+#define FRANKYCPP_WORKER_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * A single persistent thread which runs the same job each time it is
+ * started. Other than ThreadPool::enqueue starting the job creates no task,
+ * shared state or future and therefore does not allocate memory. The thread
+ * waits on a condition variable between runs.
+ * The job must not throw as there is no future to pass an exception to.
+ */
+class Worker {
+  std::function<void()> job;
+  std::mutex mutex{};
+  std::condition_variable condition{};
+  bool requested = false;// job started and not yet finished
+  bool stopping  = false;
+  std::thread thread{};
+
+public:
+  /* Creates the worker thread which waits until start() is called */
+  explicit Worker(std::function<void()> job);
+
+  /* Lets a started job finish and stops the thread */
+  ~Worker();
+
+  // disallow copies
+  Worker(Worker const&) = delete;            // copy
+  Worker& operator=(const Worker&) = delete; // copy assignment
+  Worker(Worker const&&)           = delete; // move
+  Worker& operator=(const Worker&&) = delete;// move assignment
+
+  /* Runs the job once on the worker thread. A previous run has to finish
+   * before the job is started again. */
+  void start();
+
+  /* Waits until the last started run of the job has finished */
+  void wait();
+};
+
+#endif//FRANKYCPP_WORKER_H
@@ -0,0 +1,179 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <algorithm>
+
+#include "MovePicker.h"
+#include "See.h"
+#include "chesscore/History.h"
+#include "chesscore/Position.h"
+
+// upper limit for the history bonus of quiet moves to keep the sort
+// value within the range which can be encoded into a move
+static constexpr int64_t MAX_HISTORY_BONUS = 10'000;
+
+MovePicker::MovePicker(Position& position, const GenMode genMode, const bool evasion, const Move ttMove,
+                       const Move* const killerMoves, const Move counterMove, const History* const history,
+                       const bool legalOnly)
+    : position(position),
+      genMode(genMode),
+      evasion(evasion),
+      ttMove(moveOf(ttMove)),
+      killers{moveOf(killerMoves[0]), moveOf(killerMoves[1])},
+      counterMove(moveOf(counterMove)),
+      historyData(history),
+      legal(legalOnly) {
+  if (legal) pinned = position.pinnedPieces(position.getNextPlayer());
+}
+
+Move MovePicker::next() {
+  Move move;
+  while ((move = nextPseudoLegal()) != MOVE_NONE) {
+    if (!legal || isLegal(move)) return move;
+  }
+  return MOVE_NONE;
+}
+
+Move MovePicker::nextPseudoLegal() {
+  while (true) {
+    switch (stage) {
+      case TT_MOVE:
+        stage = GEN_CAPTURES;
+        // the TT move might be from a different position with the same key
+        // bits and is only returned if it matches the generation mode
+        if (ttMove && position.isPseudoLegalMove(ttMove)
+            && (genMode == GenAll || (genMode == GenNonQuiet) == isNonQuiet(ttMove))) {
+          return ttMove;
+        }
+        break;
+
+      case GEN_CAPTURES:
+        // captures already have a MVV-LVA sort value from the generator
+        if (genMode & GenNonQuiet) {
+          MoveGenerator::generateStageMoves(position, &moves, GenNonQuiet, evasion);
+        }
+        stage = GOOD_CAPTURES;
+        break;
+
+      case GOOD_CAPTURES:
+        while (current < moves.size()) {
+          const Move move = pickBest();
+          if (move == ttMove) continue;
+          // losing captures of more valuable pieces are searched last
+          if (position.isCapturingMove(move) && typeOf(move) != ENPASSANT
+              && valueOf(position.getPiece(fromSquare(move))) > valueOf(position.getPiece(toSquare(move)))
+              && See::see(position, move) < 0) {
+            badCaptures.push_back(move);
+            continue;
+          }
+          return move;
+        }
+        current = 0;
+        stage   = (genMode & GenQuiet) ? KILLER_1 : BAD_CAPTURES;
+        break;
+
+      case KILLER_1:
+        stage = KILLER_2;
+        if (isValidQuiet(killers[0])) return killers[0];
+        break;
+
+      case KILLER_2:
+        stage = COUNTER_MOVE;
+        if (killers[1] != killers[0] && isValidQuiet(killers[1])) return killers[1];
+        break;
+
+      case COUNTER_MOVE:
+        stage = GEN_QUIETS;
+        if (counterMove != killers[0] && counterMove != killers[1] && isValidQuiet(counterMove)) return counterMove;
+        break;
+
+      case GEN_QUIETS:
+        moves.clear();
+        MoveGenerator::generateStageMoves(position, &moves, GenQuiet, evasion);
+        scoreQuiets();
+        stage = QUIETS;
+        break;
+
+      case QUIETS:
+        while (current < moves.size()) {
+          const Move move = pickBest();
+          if (!isSpecialMove(move)) return move;
+        }
+        current = 0;
+        stage   = BAD_CAPTURES;
+        break;
+
+      case BAD_CAPTURES:
+        if (current < badCaptures.size()) return badCaptures[current++];
+        stage = END;
+        break;
+
+      case END:
+        return MOVE_NONE;
+    }
+  }
+}
+
+Move MovePicker::pickBest() {
+  std::size_t best = current;
+  for (std::size_t i = current + 1; i < moves.size(); ++i) {
+    if (valueOf(moves[i]) > valueOf(moves[best])) best = i;
+  }
+  std::swap(moves[current], moves[best]);
+  return moveOf(moves[current++]);
+}
+
+bool MovePicker::isNonQuiet(const Move move) const {
+  // same distinction as in the move generator
+  return position.isCapturingMove(move)
+         || (typeOf(move) == PROMOTION && (promotionTypeOf(move) == QUEEN || promotionTypeOf(move) == KNIGHT));
+}
+
+bool MovePicker::isValidQuiet(const Move move) const {
+  // promotions are not used as killers or counter moves as queen and
+  // knight promotions are already returned with the captures
+  return move != MOVE_NONE && move != ttMove && typeOf(move) != PROMOTION
+         && !position.isCapturingMove(move) && position.isPseudoLegalMove(move);
+}
+
+bool MovePicker::isLegal(const Move move) const {
+  // tt, killer and counter moves are not generated and might not be
+  // evasions when in check - these need the full test
+  if (evasion && (move == ttMove || move == killers[0] || move == killers[1] || move == counterMove)) {
+    return position.isLegalMove(move);
+  }
+  return position.isLegalMove(move, pinned);
+}
+
+bool MovePicker::isSpecialMove(const Move move) const {
+  // quiet moves are pseudo legal so killers and counter moves which are
+  // in the list have been returned already - unless they are promotions
+  return move == ttMove
+         || ((move == killers[0] || move == killers[1] || move == counterMove) && typeOf(move) != PROMOTION);
+}
+
+void MovePicker::scoreQuiets() {
+  if (!historyData) return;
+  const Color us = position.getNextPlayer();
+  for (Move& move : moves) {
+    const int64_t count = historyData->historyCount[us][fromSquare(move)][toSquare(move)];
+    const auto bonus    = static_cast<Value>(std::min(count / 100, MAX_HISTORY_BONUS));
+    if (bonus > 0) setValueOf(move, valueOf(move) + bonus);
+  }
+}
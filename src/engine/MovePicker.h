@@ -0,0 +1,135 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef FRANKYCPP_MOVEPICKER_H
+#define FRANKYCPP_MOVEPICKER_H
+
+#include "chesscore/MoveGenerator.h"
+#include "types/types.h"
+
+// forward declaration
+class Position;
+struct History;
+
+// MovePicker returns the pseudo legal moves of a position one by one in
+// the order in which the search should try them. Moves are generated and
+// scored lazily in stages and the best remaining move of a stage is picked
+// by selection instead of sorting the whole list. As most nodes with a beta
+// cut off only use the first one or two moves this avoids sorting moves
+// which are never searched and often even generating the quiet moves.
+//
+// Stages:
+//  TT move        - the move from the TT (or IID) if it is pseudo legal
+//  good captures  - captures and queen/knight promotions by MVV-LVA, captures
+//                   of more valuable pieces with a negative SEE are deferred
+//  killers        - the two killer moves of the ply if pseudo legal and quiet
+//  counter move   - the counter move to the last move if pseudo legal and quiet
+//  quiets         - all other quiet moves by history count and position value
+//  bad captures   - the deferred captures in MVV-LVA order
+//
+// A MovePicker is created for each node and only valid for the position
+// it has been created with. Moves are returned without sort values.
+// If legal moves are requested the pinned pieces are computed once for the
+// node and each move is tested against them (and the checkers through the
+// evasion generation) before it is returned. The caller does not need to
+// test the legality of these moves after making them.
+class MovePicker {
+public:
+  enum Stage : uint8_t {
+    TT_MOVE,
+    GEN_CAPTURES,
+    GOOD_CAPTURES,
+    KILLER_1,
+    KILLER_2,
+    COUNTER_MOVE,
+    GEN_QUIETS,
+    QUIETS,
+    BAD_CAPTURES,
+    END
+  };
+
+private:
+  Position& position;
+  const GenMode genMode;
+  const bool evasion;
+
+  const Move ttMove;
+  const Move killers[2];
+  const Move counterMove;
+  const History* const historyData;
+  const bool legal;
+
+  // pinned pieces of the next player - only computed for legal moves
+  Bitboard pinned = BbZero;
+
+  Stage stage = TT_MOVE;
+
+  // moves of the current stage and the index of the next move to pick
+  MoveList moves;
+  std::size_t current = 0;
+
+  // captures with a negative SEE are searched after all quiet moves
+  MoveList badCaptures;
+
+public:
+  // @param position the position to pick moves for (not changed)
+  // @param genMode GenAll, GenNonQuiet (captures and promotions) or GenQuiet
+  // @param evasion true if the position has check (only evasions are generated)
+  // @param ttMove best move from TT or IID or MOVE_NONE
+  // @param killerMoves the two killer moves of the ply
+  // @param counterMove the move which refuted the last move before or MOVE_NONE
+  // @param history history data for sorting quiet moves or nullptr
+  // @param legalOnly only return legal moves
+  MovePicker(Position& position, GenMode genMode, bool evasion, Move ttMove,
+             const Move* killerMoves, Move counterMove, const History* history,
+             bool legalOnly = false);
+
+  // Returns the next move or MOVE_NONE if there are no more moves
+  Move next();
+
+  [[nodiscard]] Stage getStage() const { return stage; }
+
+  // true if only legal moves are returned
+  [[nodiscard]] bool isLegalOnly() const { return legal; }
+
+private:
+  // returns the next pseudo legal move of the stages
+  Move nextPseudoLegal();
+
+  // legality test with the pinned pieces of the position
+  [[nodiscard]] bool isLegal(Move move) const;
+
+  // picks the move with the highest sort value from the remaining moves
+  // of the current stage by swapping it to the current position
+  Move pickBest();
+
+  // true if the move was returned in an earlier stage
+  [[nodiscard]] bool isSpecialMove(Move move) const;
+
+  // true for captures and queen and knight promotions (GenNonQuiet)
+  [[nodiscard]] bool isNonQuiet(Move move) const;
+
+  // true if the move could be a killer or counter move on this position
+  [[nodiscard]] bool isValidQuiet(Move move) const;
+
+  // adds the history count to the sort value of all quiet moves
+  void scoreQuiets();
+};
+
+#endif//FRANKYCPP_MOVEPICKER_H
@@ -19,9 +19,11 @@
 
 #include <thread>
 #include <bit>
+#include <new>
 
 #include "common/Logging.h"
 #include "PawnTT.h"
+#include "SearchConfig.h"
 
 PawnTT::PawnTT(uint64_t newSizeInMByte) {
   noOfThreads = std::thread::hardware_concurrency();
@@ -50,13 +52,14 @@ void PawnTT::resize(const uint64_t newSizeInMByte) {
   if (sizeInByte == 0) maxNumberOfEntries = 0;
   sizeInByte = maxNumberOfEntries * ENTRY_SIZE;
 
-  delete[] _data;
-  _data = new Entry[maxNumberOfEntries];
+  _data = static_cast<Entry*>(memory.allocate(maxNumberOfEntries * ENTRY_SIZE,
+                                              SearchConfig::USE_LARGE_PAGES,
+                                              SearchConfig::USE_NUMA_INTERLEAVE));
 
   clear();
   if (maxNumberOfEntries) {
-    LOG__INFO(Logger::get().EVAL_LOG, "PawnTT Size {:L} MByte, Capacity {:L} entries (size={}Byte) (Requested were {:L} MBytes)",
-              sizeInByte / MB, maxNumberOfEntries, sizeof(Entry), newSizeInMByte);
+    LOG__INFO(Logger::get().EVAL_LOG, "PawnTT Size {:L} MByte, Capacity {:L} entries (size={}Byte) using {} (Requested were {:L} MBytes)",
+              sizeInByte / MB, maxNumberOfEntries, sizeof(Entry), memory.str(), newSizeInMByte);
   }
 }
 
@@ -66,10 +69,11 @@ void PawnTT::clear() {
     return;
   }
   // This clears the PawnTT by overwriting each entry with 0.
-  // It uses multiple threads if noOfThreads is > 1.
+  // It uses multiple threads if noOfThreads is > 1. Pages of a new
+  // table are placed on the NUMA node of the clearing thread (first touch).
   LOG__TRACE(Logger::get().EVAL_LOG, "Clearing PawnTT ({} threads)...", noOfThreads);
 
-  auto startTime = std::chrono::high_resolution_clock::now();
+  [[maybe_unused]] auto startTime = std::chrono::high_resolution_clock::now();
   std::vector<std::thread> threads;
   threads.reserve(noOfThreads);
 
@@ -81,9 +85,7 @@ void PawnTT::clear() {
       auto end   = start + range;
       if (t == noOfThreads - 1) end = maxNumberOfEntries;
       for (std::size_t i = start; i < end; ++i) {
-        _data[i].key      = 0;
-        _data[i].midvalue = VALUE_NONE;
-        _data[i].endvalue = VALUE_NONE;
+        new (&_data[i]) Entry();
       }
     });
   }
@@ -97,10 +99,8 @@ void PawnTT::clear() {
   numberOfUpdates = 0;
   numberOfMisses  = 0;
 
-  auto finish = std::chrono::high_resolution_clock::now();
-  auto time   = std::chrono::duration_cast<std::chrono::milliseconds>(finish - startTime).count();
-
-  LOG__DEBUG(Logger::get().EVAL_LOG, "PawnTT cleared {:L} entries in {:L} ms ({} threads)", maxNumberOfEntries, time, noOfThreads);
+  LOG__DEBUG(Logger::get().EVAL_LOG, "PawnTT cleared {:L} entries in {:L} ms ({} threads)", maxNumberOfEntries,
+             std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - startTime).count(), noOfThreads);
 }
 
 void PawnTT::put(Entry* entryDataPtr, Key key, Score score) {
@@ -132,9 +132,9 @@ void PawnTT::put(Entry* entryDataPtr, Key key, Score score) {
 
 std::string PawnTT::str() {
   return fmt::format(
-    "PawnTT: size {:L} MB max entries {:L} of size {:L} Bytes entries {:L} puts {:L} "
+    "PawnTT: size {:L} MB ({}) max entries {:L} of size {:L} Bytes entries {:L} puts {:L} "
     "updates {:L} collisions {:L} overwrites {:L} hits {:L} ({:L}%) misses {:L} ({:L}%)",
-    sizeInByte / MB, maxNumberOfEntries, sizeof(Entry), numberOfEntries,
+    sizeInByte / MB, memory.str(), maxNumberOfEntries, sizeof(Entry), numberOfEntries,
     numberOfPuts, numberOfUpdates, numberOfCollisions, numberOfOverwrites,
     numberOfHits, numberOfQueries ? (numberOfHits * 100) / numberOfQueries : 0,
     numberOfMisses, numberOfQueries ? (numberOfMisses * 100) / numberOfQueries : 0);
@@ -20,6 +20,7 @@
 #ifndef FRANKYCPP_PAWNTT_H
 #define FRANKYCPP_PAWNTT_H
 
+#include "common/LargeMemory.h"
 #include "types/types.h"
 
 // pre-fetching of TT entries into CPU caches
@@ -70,6 +71,9 @@ public:
   static_assert(CacheLineSize % ENTRY_SIZE == 0, "Cluster size incorrect");
 
 private:
+  // memory block (large pages if available) holding the entries
+  LargeMemory memory;
+
   // this array hold the actual entries for the transposition table
   Entry* _data{};
 
@@ -98,9 +102,7 @@ public:
   // newSizeInMByte Size of TT in bytes which will be reduced to the next lowest power of 2 size
   explicit PawnTT(uint64_t newSizeInMByte);
 
-  ~PawnTT() {
-    delete[] _data;
-  }
+  ~PawnTT() = default;
 
   // disallow copies
   PawnTT(PawnTT const& tt) = delete;         // copy
@@ -165,6 +167,10 @@ std::size_t getNumberOfEntries() const {
   return numberOfEntries;
 }
 
+  std::size_t getPageSize() const {
+    return memory.getPageSize();
+  }
+
   uint64_t getNumberOfHits() const {
     return numberOfHits;
   }
@@ -0,0 +1,94 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef FRANKYCPP_PVTABLE_H
+#define FRANKYCPP_PVTABLE_H
+
+#include "types/types.h"
+#include <array>
+#include <cassert>
+#include <cstring>
+
+// Triangular table of principal variations - one row per ply.
+// The row of a ply holds the pv of the node at this ply and is
+// at most SIZE - ply moves long. All rows are stored contiguously
+// in one fixed array so saving a pv is a single memcpy of the child's
+// row and never touches the allocator.
+// Each row has its own length counter. Rows are only reset explicitly
+// (clear) so a row keeps its last pv until the node is searched again.
+class PvTable {
+public:
+  // one row for each ply including the leaf at MAX_DEPTH
+  static constexpr int SIZE = MAX_DEPTH + 1;
+
+private:
+  std::array<Move, SIZE*(SIZE + 1) / 2> moves{};
+  std::array<int, SIZE> length{};
+
+  // index of the first move of a ply's row (sum of the previous row sizes)
+  static constexpr int offset(int ply) { return ply * SIZE - ply * (ply - 1) / 2; }
+
+public:
+  // number of moves a ply's row can hold
+  static constexpr int capacity(int ply) { return SIZE - ply; }
+
+  inline void clear(int ply) { length[ply] = 0; }
+
+  void clearAll() { length.fill(0); }
+
+  inline bool empty(int ply) const { return length[ply] == 0; }
+
+  inline int size(int ply) const { return length[ply]; }
+
+  inline Move& at(int ply, int i) {
+    assert(i < length[ply] && "PvTable index out of range");
+    return moves[offset(ply) + i];
+  }
+
+  inline const Move& at(int ply, int i) const {
+    assert(i < length[ply] && "PvTable index out of range");
+    return moves[offset(ply) + i];
+  }
+
+  // appends a move to the ply's row if there is room left
+  inline void push_back(int ply, Move move) {
+    if (length[ply] < capacity(ply)) moves[offset(ply) + length[ply]++] = move;
+  }
+
+  // sets move as the first move of the ply's row followed by the
+  // pv of the child node (row ply + 1)
+  inline void save(int ply, Move move) {
+    assert(ply + 1 < SIZE && "PvTable has no child row for this ply");
+    const int row       = offset(ply);
+    const int childSize = length[ply + 1];
+    moves[row]          = move;
+    std::memcpy(&moves[row + 1], &moves[offset(ply + 1)], childSize * sizeof(Move));
+    length[ply] = childSize + 1;
+  }
+
+  // returns a copy of the ply's row as a move list
+  MoveList line(int ply) const {
+    MoveList list{};
+    const int row = offset(ply);
+    for (int i = 0; i < length[ply]; ++i) list.push_back(moves[row + i]);
+    return list;
+  }
+};
+
+#endif//FRANKYCPP_PVTABLE_H
@@ -31,13 +31,18 @@ Search::Search() : Search(nullptr) {}
 
 Search::Search(UciHandler* pUciHandler) {
   this->uciHandler = pUciHandler;
-  this->tt         = std::make_unique<TT>(0);
+  this->tt         = std::make_shared<TT>(0);
+}
+
+Search::Search(std::shared_ptr<TT> sharedTT, int id) {
+  this->tt       = std::move(sharedTT);
+  this->helperId = id;
 }
 
 Search::~Search() {
-  // necessary to avoid err message:
-  // terminate called without an active exception
-  if (searchThread.joinable()) { searchThread.join(); }
+  // wait for a running search before the worker threads are stopped
+  if (searchWorker) searchWorker->wait();
+  stopHelpers();
 }
 
 ////////////////////////////////////////////////
@@ -45,9 +50,12 @@ Search::~Search() {
 
 void Search::newGame() {
   if (isSearching()) stopSearch();
-  tt->clear();
+  // a persistent hash loaded from file is kept - clearing it would also
+  // copy every page of the file mapping
+  if (!keepTTForNewGame()) tt->clear();
   evaluator = std::make_unique<Evaluator>();
   history   = History{};
+  helpers.clear();// helpers will be recreated with fresh history and evaluator
 }
 
 void Search::isReady() {
@@ -65,16 +73,19 @@ void Search::startSearch(Position p, SearchLimits sl) {
   startTime       = currentTime();
   startSearchTime = startTime;
 
+  // a loaded hash is only kept for the new game started before the first
+  // search - later games clear the hash as usual
+  ttLoaded = false;
+
   // move the received copy of position and search limits to instance variables
   this->position     = p;
   this->searchLimits = std::move(sl);
 
-  // join() previous thread
-  if (searchThread.joinable()) { searchThread.join(); }
-
-  // start search in a separate thread
+  // start search on the persistent search worker thread - this waits for
+  // the previous search to have completely finished
   LOG__DEBUG(Logger::get().SEARCH_LOG, "Starting search in separate thread.");
-  searchThread = std::thread(&Search::run, this);
+  if (!searchWorker) searchWorker = std::make_unique<Worker>([this] { run(); });
+  searchWorker->start();
 
   // wait until search is running and initialization
   // is done before returning to caller
@@ -90,10 +101,8 @@ void Search::stopSearch() {
   }
   LOG__INFO(Logger::get().SEARCH_LOG, "Search stopped.");
   stopSearchFlag = true;
-  // Wait for the thread to die
-  if (searchThread.joinable()) {
-    searchThread.join();
-  }
+  // Wait for the search to finish
+  if (searchWorker) searchWorker->wait();
   waitWhileSearching();
 }
 
@@ -130,6 +139,7 @@ void Search::clearTT() {
     return;
   }
   tt->clear();
+  ttLoaded              = false;
   const std::string msg = "Hash cleared.";
   sendString(msg);
   LOG__INFO(Logger::get().SEARCH_LOG, msg);
@@ -142,11 +152,47 @@ void Search::resizeTT() {
     LOG__WARN(Logger::get().SEARCH_LOG, msg);
     return;
   }
-  tt = std::make_unique<TT>(0);// clear the old TT (is smart pointer and memory is freed)
-  initialize();                // re-initialize
+  tt       = std::make_shared<TT>(0);// clear the old TT (is smart pointer and memory is freed)
+  ttLoaded = false;
+  initialize();// re-initialize
   sendString("Resized hash: " + tt->str());
 }
 
+bool Search::keepTTForNewGame() const {
+  return SearchConfig::TT_PERSISTENT && ttLoaded;
+}
+
+void Search::saveTT(const std::string& path) {
+  if (isSearching()) {
+    const std::string msg = "Can't save hash while searching.";
+    sendString(msg);
+    LOG__WARN(Logger::get().SEARCH_LOG, msg);
+    return;
+  }
+  if (tt->save(path)) {
+    sendString("Saved hash to " + path);
+  }
+  else {
+    sendString("Could not save hash to " + path);
+  }
+}
+
+void Search::loadTT(const std::string& path) {
+  if (isSearching()) {
+    const std::string msg = "Can't load hash while searching.";
+    sendString(msg);
+    LOG__WARN(Logger::get().SEARCH_LOG, msg);
+    return;
+  }
+  if (tt->load(path)) {
+    ttLoaded = true;
+    sendString("Loaded hash: " + tt->str());
+  }
+  else {
+    sendString("Could not load hash from " + path);
+  }
+}
+
 ////////////////////////////////////////////////
 ///// PRIVATE
 
@@ -161,14 +207,16 @@ void Search::run() {
   LOG__INFO(Logger::get().SEARCH_LOG, "Searching " + position.strFen());
 
   // initialize search
-  stopSearchFlag    = false;
-  hasResultFlag     = false;
-  timeLimit         = milliseconds{};
-  extraTime         = milliseconds{};
-  nodesVisited      = 0;
-  statistics        = SearchStats{};
-  lastUciUpdateTime = nowFast();
-  npsTime           = lastUciUpdateTime;
+  stopSearchFlag     = false;
+  hasResultFlag      = false;
+  timeLimit          = milliseconds{};
+  extraTime          = milliseconds{};
+  nodesVisited       = 0;
+  statistics         = SearchStats{};
+  lastUciUpdateTime  = nowFast();
+  npsTime            = lastUciUpdateTime;
+  deadline           = TimePoint::max();
+  nextTimeCheckNodes = 0;
   initialize();
 
   // setup and report search limits
@@ -179,10 +227,10 @@ void Search::run() {
     startTimer();
   }
 
-  // age tt entries
+  // start a new tt generation (ages all entries)
   if (tt->getMaxNumberOfEntries()) {
-    LOG__INFO(Logger::get().SEARCH_LOG, "Transposition Table: Using TT: " + tt->str());
-    tt->ageEntries();
+    LOG__INFO(Logger::get().SEARCH_LOG, "Transposition Table: Using TT: {}", tt->str());
+    tt->newGeneration();
   }
   else {
     LOG__INFO(Logger::get().SEARCH_LOG, "Transposition Table: Not using TT.");
@@ -190,7 +238,6 @@ void Search::run() {
 
   // Initialize ply based data
   // move generators for each ply
-  // pv move list for each ply
   // Each depth in search gets it own global
   // field to avoid object creation during search.
   for (int i = DEPTH_NONE; i < DEPTH_MAX; i++) {
@@ -198,8 +245,8 @@ void Search::run() {
     if (SearchConfig::USE_HISTORY_COUNTER || SearchConfig::USE_HISTORY_MOVES) {
       this->mg[i].setHistoryData(&history);
     }
-    pv[i].clear();
   }
+  pv.clearAll();
 
   // release the init phase lock to signal the calling go routine
   // waiting in StartSearch() to return
@@ -221,7 +268,9 @@ void Search::run() {
   // Otherwise start search with iterative deepening.
   SearchResult searchResult{};
   if (!bookMove) {
+    startHelpers();
     searchResult = iterativeDeepening(position);
+    stopHelpers();
   }
   else {
     searchResult.bestMove = bookMove;
@@ -245,20 +294,21 @@ void Search::run() {
   // make sure timer stops as this could potentially still be running
   // when search finished without any stop signal/limit
   stopSearchFlag = true;
+  notifyTimer();
 
   // update search result with search time and pv
   searchResult.time  = currentTime() - startSearchTime;
-  searchResult.pv    = pv[0];
-  searchResult.nodes = nodesVisited;
+  searchResult.pv    = pv.line(0);
+  searchResult.nodes = getTotalNodes();
 
   // print stats to log
   LOG__INFO(Logger::get().SEARCH_LOG, "Search finished after {}", str(searchResult.time));
-  LOG__INFO(Logger::get().SEARCH_LOG, "Search depth was {}({}) with {:L} nodes visited. NPS = {:L} nps", statistics.currentSearchDepth, statistics.currentExtraSearchDepth, nodesVisited, nps(nodesVisited, searchResult.time));
+  LOG__INFO(Logger::get().SEARCH_LOG, "Search depth was {}({}) with {:L} nodes visited. NPS = {:L} nps", statistics.currentSearchDepth, statistics.currentExtraSearchDepth, searchResult.nodes, nps(searchResult.nodes, searchResult.time));
   LOG__DEBUG(Logger::get().SEARCH_LOG, "Search stats: {}", statistics.str());
 
   // print result to log
   if (searchLimits.mate && searchResult.mateFound) {
-    LOG__INFO(Logger::get().SEARCH_LOG, "Mate in {} found: {}", searchLimits.mate, str(pv[0].at(0)));
+    LOG__INFO(Logger::get().SEARCH_LOG, "Mate in {} found: {}", searchLimits.mate, str(pv.at(0, 0)));
   }
   LOG__INFO(Logger::get().SEARCH_LOG, "Search result: {}", searchResult.str());
 
@@ -270,13 +320,77 @@ void Search::run() {
   // searched has been stopped.
   sendResult(searchResult);
 
-  // clean up timer thread if necessary
-  if (timerThread.joinable()) timerThread.join();
+  // wait for the timer to end if necessary
+  if (timerWorker) timerWorker->wait();
 
   // release the running semaphore after the search has ended
   isRunningSemaphore.release();
 }
 
+void Search::startHelpers() {
+  const auto noOfHelpers = static_cast<size_t>(std::max(1, SearchConfig::THREADS) - 1);
+  // create missing helpers or remove the ones not needed anymore
+  while (helpers.size() < noOfHelpers) {
+    helpers.push_back(std::unique_ptr<Search>(new Search(tt, static_cast<int>(helpers.size()) + 1)));
+  }
+  helpers.resize(noOfHelpers);
+  if (helpers.empty()) {
+    return;
+  }
+  LOG__INFO(Logger::get().SEARCH_LOG, "Starting {} helper threads (Lazy SMP)", helpers.size());
+  for (auto& helper : helpers) {
+    // the TT might have been resized or re-initialized since the last search
+    helper->tt              = tt;
+    helper->position        = position;
+    helper->searchLimits    = searchLimits;
+    helper->startSearchTime = startSearchTime;
+    // node limits are checked by the main search against the total nodes
+    helper->searchLimits.nodes = 0;
+    helper->stopSearchFlag     = false;
+    if (!helper->searchWorker) {
+      helper->searchWorker = std::make_unique<Worker>([h = helper.get()] { h->runHelper(); });
+    }
+    helper->searchWorker->start();
+  }
+}
+
+void Search::stopHelpers() {
+  for (auto& helper : helpers) {
+    helper->stopSearchFlag = true;
+  }
+  for (auto& helper : helpers) {
+    if (helper->searchWorker) helper->searchWorker->wait();
+  }
+}
+
+void Search::runHelper() {
+  nodesVisited       = 0;
+  helperNodes        = 0;
+  lastUciUpdateNodes = 0;
+  nextTimeCheckNodes = 0;
+  statistics         = SearchStats{};
+  if (!evaluator) {
+    evaluator = std::make_unique<Evaluator>();
+  }
+  for (int i = DEPTH_NONE; i < DEPTH_MAX; i++) {
+    this->mg[i] = MoveGenerator{};
+    if (SearchConfig::USE_HISTORY_COUNTER || SearchConfig::USE_HISTORY_MOVES) {
+      this->mg[i].setHistoryData(&history);
+    }
+  }
+  pv.clearAll();
+  iterativeDeepening(position);
+  helperNodes = nodesVisited;
+}
+
+uint64_t Search::getTotalNodes() const {
+  uint64_t nodes = nodesVisited;
+  for (const auto& helper : helpers) {
+    nodes += helper->helperNodes;
+  }
+  return nodes;
+}
+
 SearchResult Search::iterativeDeepening(Position& p) {
   SearchResult searchResult{};
 
@@ -354,6 +468,17 @@ SearchResult Search::iterativeDeepening(Position& p) {
   // ###########################################
   // ### BEGIN Iterative Deepening
   for (auto iterationDepth = Depth{1}; iterationDepth <= maxDepth; ++iterationDepth) {
+    // Lazy SMP: helpers skip certain iterations so that the threads
+    // are spread over different depths instead of all searching the
+    // same tree. The first iteration is never skipped to always have
+    // a pv move.
+    if (helperId && iterationDepth > 1) {
+      const int i = (helperId - 1) % 20;
+      if (((static_cast<int>(iterationDepth) + SKIP_PHASE[i]) / SKIP_SIZE[i]) % 2) {
+        continue;
+      }
+    }
+
     // update search counter
     nodesVisited++;
 
@@ -379,10 +504,10 @@ SearchResult Search::iterativeDeepening(Position& p) {
     }
     // ###########################################
 
-    assert((bestValue == valueOf(pv[0].at(0)) || stopSearchFlag) && "bestValue should be equal value of pv[0].at(0)");
+    assert((bestValue == valueOf(pv.at(0, 0)) || stopSearchFlag) && "bestValue should be equal value of pv[0].at(0)");
 
     // if mate search check if we found a mate within the mate limit
-    if (searchLimits.mate && abs(valueOf(pv[0].at(0))) >= VALUE_CHECKMATE_THRESHOLD && searchLimits.mate * 2 - 1 == VALUE_CHECKMATE - valueOf(pv[0].at(0))) {
+    if (searchLimits.mate && abs(valueOf(pv.at(0, 0))) >= VALUE_CHECKMATE_THRESHOLD && searchLimits.mate * 2 - 1 == VALUE_CHECKMATE - valueOf(pv.at(0, 0))) {
       searchResult.mateFound = true;
       break;
     }
@@ -394,10 +519,10 @@ SearchResult Search::iterativeDeepening(Position& p) {
     // If we only have one move to play also stop the search
     if (!stopConditions() && rootMoves.size() > 1) {
       // sort root moves for the next iteration
-      std::stable_sort(rootMoves.begin(), rootMoves.end(), moveValueGreaterComparator());
-      statistics.currentBestRootMove      = pv[0].at(0);
-      statistics.currentBestRootMoveValue = valueOf(pv[0].at(0));
-      assert(pv[0].at(0) == rootMoves.at(0) && "Best root move should be equal to pv[0].at(0)");
+      sortMovesByValue(rootMoves.begin(), rootMoves.end());
+      statistics.currentBestRootMove      = pv.at(0, 0);
+      statistics.currentBestRootMoveValue = valueOf(pv.at(0, 0));
+      assert(pv.at(0, 0) == rootMoves.at(0) && "Best root move should be equal to pv[0].at(0)");
       // update UCI GUI
       sendIterationEndInfoToUci();
     }
@@ -411,25 +536,27 @@ SearchResult Search::iterativeDeepening(Position& p) {
   // update searchResult
   // best move is pv[0][0] - we need to make sure this array entry exists at this time
   // best value is pv[0][0].valueOf
-  searchResult.bestMove      = moveOf(pv[0].at(0));
-  searchResult.bestMoveValue = valueOf(pv[0].at(0));
+  searchResult.bestMove      = moveOf(pv.at(0, 0));
+  searchResult.bestMoveValue = valueOf(pv.at(0, 0));
   searchResult.depth         = statistics.currentIterationDepth;
   searchResult.extraDepth    = statistics.currentExtraSearchDepth;
   searchResult.bookMove      = false;
 
   // see if we have a move we could ponder on
-  if (pv[0].size() > 1) {
-    searchResult.ponderMove = moveOf(pv[0].at(1));
+  if (pv.size(0) > 1) {
+    searchResult.ponderMove = moveOf(pv.at(0, 1));
   }
   else {
     // we do not have a ponder move in the pv list
     // so let's check the TT
     if (SearchConfig::USE_TT) {
       p.doMove(searchResult.bestMove);
-      const auto* ttEntryPtr = tt->probe(p.getZobristKey());
-      if (ttEntryPtr) {
+      const auto ttEntry = tt->probe(p.getZobristKey());
+      // moves from the TT might belong to a different position with
+      // the same key bits and need to be verified
+      if (ttEntry && p.isPseudoLegalMove(static_cast<Move>(ttEntry->move)) && p.isLegalMove(static_cast<Move>(ttEntry->move))) {
         statistics.ttHit++;
-        searchResult.ponderMove = static_cast<Move>(ttEntryPtr->move);
+        searchResult.ponderMove = static_cast<Move>(ttEntry->move);
         LOG__DEBUG(Logger::get().SEARCH_LOG, "Using ponder move from hash table: {}", str(searchResult.ponderMove));
       }
       p.undoMove();
@@ -530,7 +657,7 @@ Value Search::rootSearch(Position& p, Depth depth, Value alpha, Value beta) {
 
     p.doMove(moveRef);
     nodesVisited++;
-    statistics.currentVariation.push_back(moveRef);
+    currentLine[0] = moveRef;
     statistics.currentRootMoveIndex = i;
     statistics.currentRootMove      = moveRef;
 
@@ -542,22 +669,21 @@ Value Search::rootSearch(Position& p, Depth depth, Value alpha, Value beta) {
       // PVS
       // First move in a node is an assumed PV and searched with full search window
       if (!SearchConfig::USE_PVS || i == 0) {
-        value = -search(p, depth - 1, ply, -beta, -alpha, PV, Do_Null_Move);
+        value = -search<PV, Do_Null_Move>(p, depth - 1, ply, -beta, -alpha);
       }
       else {
         // Null window search after the initial PV search.
-        value = -search(p, depth - 1, ply, -alpha - 1, -alpha, NonPV, Do_Null_Move);
+        value = -search<NonPV, Do_Null_Move>(p, depth - 1, ply, -alpha - 1, -alpha);
         // If this move improved alpha without exceeding beta we do a proper full window
         // search to get an accurate score.
         if (value > alpha && value < beta && !stopConditions()) {
           statistics.rootPvsResearches++;
-          value = -search(p, depth - 1, ply, -beta, -alpha, PV, Do_Null_Move);
+          value = -search<PV, Do_Null_Move>(p, depth - 1, ply, -beta, -alpha);
         }
       }
       // ///////////////////////////////////////////////////////////////////
     }
 
-    statistics.currentVariation.pop_back();
     p.undoMove();
 
     // we want to do at least one complete search with depth 1
@@ -577,7 +703,7 @@ Value Search::rootSearch(Position& p, Depth depth, Value alpha, Value beta) {
     if (value > bestNodeValue) {
       bestNodeValue = value;
       // we have a new best move and pv[0][0] - store pv+1 tp pv
-      savePV(moveRef, pv[1], pv[0]);
+      pv.save(0, moveRef);
       statistics.bestMoveChange++;
       if (value > alpha) {
         // fail high in root only when using aspiration search
@@ -598,12 +724,18 @@ Value Search::rootSearch(Position& p, Depth depth, Value alpha, Value beta) {
   return bestNodeValue;
 }
 
-Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value beta, Node_Type isPv, Do_Null doNull) {
-  //  LOG__DEBUG(Logger::get().SEARCH_LOG, "Search {} {} {}", depth, ply, str(statistics.currentVariation));
+template<Search::Node_Type NT, Search::Do_Null DN>
+Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value beta) {
+  //  LOG__DEBUG(Logger::get().SEARCH_LOG, "Search {} {}", depth, ply);
+
+  // node type and null move permission are known at compile time which
+  // allows the compiler to remove the branches not needed for this node
+  constexpr bool isPv   = NT == PV;
+  constexpr bool doNull = DN == Do_Null_Move;
 
   // Enter quiescence search when depth == 0 or max ply has been reached
   if (depth == 0 || ply >= MAX_DEPTH) {
-    return qsearch(p, ply, alpha, beta, isPv);
+    return qsearch<NT>(p, ply, alpha, beta);
   }
 
   // check if search should be stopped
@@ -635,7 +767,7 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
   // TT Lookup
   // Results of searches are stored in the TT to be used to
   // avoid searching positions several times. If a position
-  // is stored in the TT we retrieve a pointer to the entry.
+  // is stored in the TT we retrieve a copy of the entry.
   // We use the stored move as a best move from previous searches
   // and search it first (through setting PV move in move gen).
   // If we have a value from a similar or deeper search we check
@@ -645,27 +777,28 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
   // this branch and return the value.
   // Alpha or Beta entries will only be used if they improve
   // the current values.
-  const TT::Entry* ttEntryPtr;
+  std::optional<TT::Entry> ttEntry;
   if (SearchConfig::USE_TT) {
-    ttEntryPtr = tt->probe(p.getZobristKey());
-    if (ttEntryPtr) {// tt hit
+    ttEntry = tt->probe(p.getZobristKey());
+    if (ttEntry) {// tt hit
       statistics.ttHit++;
-      ttMove = static_cast<Move>(ttEntryPtr->move);
-      if (ttEntryPtr->depth >= depth) {
-        const Value ttValue = valueFromTt(ttEntryPtr->value, ply);
-        if (validValue(ttValue) && (ttEntryPtr->type == EXACT || (ttEntryPtr->type == ALPHA && ttValue <= alpha) || (ttEntryPtr->type == BETA && ttValue >= beta)) && SearchConfig::USE_TT_VALUE) {
+      // verify the move as the entry might belong to a different position with the same key bits
+      ttMove = p.isPseudoLegalMove(static_cast<Move>(ttEntry->move)) ? static_cast<Move>(ttEntry->move) : MOVE_NONE;
+      if (ttEntry->depth >= depth) {
+        const Value ttValue = valueFromTt(ttEntry->value, ply);
+        if (validValue(ttValue) && (ttEntry->type == EXACT || (ttEntry->type == ALPHA && ttValue <= alpha) || (ttEntry->type == BETA && ttValue >= beta)) && SearchConfig::USE_TT_VALUE) {
           // get PV line from tt as we prune here
           // and wouldn't have one otherwise
-          getPvLine(p, pv[ply], depth);
+          getPvLine(p, ply, depth);
           statistics.TtCuts++;
           return ttValue;
         }
         statistics.TtNoCuts++;
       }
       // if we have a static eval stored we can reuse it
-      if (SearchConfig::USE_EVAL_TT && ttEntryPtr->eval != VALUE_NONE) {
+      if (SearchConfig::USE_EVAL_TT && ttEntry->eval != VALUE_NONE) {
         statistics.evalFromTT++;
-        staticEval = ttEntryPtr->eval;
+        staticEval = ttEntry->eval;
       }
     }
     else {
@@ -689,7 +822,7 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
   // jump directly into qsearch
   if (SearchConfig::USE_RAZORING && depth == 1 && staticEval != VALUE_NONE && staticEval <= alpha - SearchConfig::RAZOR_MARGIN) {
     statistics.razorings++;
-    return qsearch(p, ply, alpha, beta, PV);
+    return qsearch<PV>(p, ply, alpha, beta);
   }
 
   // Reverse Futility Pruning, (RFP, Static Null Move Pruning)
@@ -735,8 +868,9 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
 
       // do null move search
       p.doNullMove();
+      currentLine[ply] = MOVE_NONE;
       nodesVisited++;
-      Value nValue = -search(p, newDepth, ply + 1, -beta, -beta + 1, Node_Type::NonPV, Do_Null::No_Null_Move);
+      Value nValue = -search<NonPV, No_Null_Move>(p, newDepth, ply + 1, -beta, -beta + 1);
       p.undoNullMove();
 
       // check if we should stop the search
@@ -790,7 +924,7 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
       }
 
       // do the actual reduced search
-      search(p, newDepth, ply, alpha, beta, isPv, doNull);
+      search<NT, DN>(p, newDepth, ply, alpha, beta);
       statistics.iidSearches++;
 
       // check if we should stop the search
@@ -799,9 +933,9 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
       }
 
       // get the best move from the reduced search if available
-      if (!pv[ply].empty()) {
+      if (!pv.empty(ply)) {
         statistics.iidMoves++;
-        ttMove = moveOf(pv[ply][0]);
+        ttMove = moveOf(pv.at(ply, 0));
       }
     }
   }
@@ -809,20 +943,19 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
   // reset search
   // !important to do this after IID!
   const auto myMg = &mg[ply];
-  myMg->resetOnDemand();
-  pv[ply].clear();
+  pv.clear(ply);
 
   // PV Move Sort
   // When we received a best move for the position from the
-  // TT or IID we set it as PV move in the movegen so it will
+  // TT or IID we give it to the move picker so it will
   // be searched first.
   if (SearchConfig::USE_TT_PV_MOVE_SORT && ttMove != MOVE_NONE) {
     statistics.TtMoveUsed++;
-    myMg->setPV(ttMove);
   }
   else {
     statistics.NoTtMove++;
   }
+  MovePicker picker = createMovePicker(p, ply, GenAll, hasCheck, ttMove);
 
   // prepare move loop
   Value value       = VALUE_NONE;
@@ -831,7 +964,7 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
 
   // ///////////////////////////////////////////////////////
   // MOVE LOOP
-  while ((move = myMg->getNextPseudoLegalMove(p, GenAll, hasCheck)) != MOVE_NONE) {
+  while ((move = picker.next()) != MOVE_NONE) {
     const Square from     = fromSquare(move);
     const Square to       = toSquare(move);
     const bool givesCheck = p.givesCheck(move);
@@ -945,7 +1078,9 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
     // DO MOVE
     p.doMove(move);
 
-    if (!p.wasLegalMove()) {
+    // moves from a legal move picker need no test after the move
+    assert((!picker.isLegalOnly() || p.wasLegalMove()) && "move picker returned illegal move");
+    if (!picker.isLegalOnly() && !p.wasLegalMove()) {
       p.undoMove();
       continue;
     }
@@ -957,9 +1092,9 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
 
     // we only count legal moves
     nodesVisited++;
-    statistics.currentVariation.push_back(move);
+    currentLine[ply] = move;
 
-    sendSearchUpdateToUci();
+    sendSearchUpdateToUci(ply);
 
     // check repetition and 50 moves
     if (checkDrawRepAnd50(p, 2)) {
@@ -975,13 +1110,13 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
       // to research the move again with a full window.
       // https://www.chessprogramming.org/Principal_Variation_Search
       if (!SearchConfig::USE_PVS || movesSearched == 0) {
-        value = -search(p, newDepth, ply + 1, -beta, -alpha, PV, Do_Null_Move);
+        value = -search<PV, Do_Null_Move>(p, newDepth, ply + 1, -beta, -alpha);
       }
       else {
         // Null window search after the initial PV search.
         // As depth we use a potentially reduced depth if Late Move Reduction
         // conditions have been met above.
-        value = -search(p, lmrDepth, ply + 1, -alpha - 1, -alpha, NonPV, Do_Null_Move);
+        value = -search<NonPV, Do_Null_Move>(p, lmrDepth, ply + 1, -alpha - 1, -alpha);
         // If this move improved alpha without exceeding beta we do a proper full window
         // search to get an accurate score.
         // Without LMR we check for value > alpha && value < beta
@@ -990,11 +1125,11 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
           // did we actually have a LMR reduction?
           if (lmrDepth < newDepth) {
             statistics.lmrResearches++;
-            value = -search(p, newDepth, ply + 1, -beta, -alpha, PV, Do_Null_Move);
+            value = -search<PV, Do_Null_Move>(p, newDepth, ply + 1, -beta, -alpha);
           }
           else if (value < beta) {
             statistics.pvsResearches++;
-            value = -search(p, newDepth, ply + 1, -beta, -alpha, PV, Do_Null_Move);
+            value = -search<PV, Do_Null_Move>(p, newDepth, ply + 1, -beta, -alpha);
           }
         }
       }
@@ -1002,7 +1137,6 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
     }
 
     movesSearched++;
-    statistics.currentVariation.pop_back();
     p.undoMove();
     // UNDO MOVE
     // ///////////////////////////////////////////////////////
@@ -1066,7 +1200,7 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
         // We found a move between alpha and beta which means we
         // really have found the best move so far in the ply which
         // can be forced (opponent can't avoid it).
-        savePV(move, pv[ply + 1], pv[ply]);
+        pv.save(ply, move);
 
         // We raise alpha so the successive searches in this ply
         // need to find even better moves or dismiss the moves.
@@ -1111,8 +1245,11 @@ Value Search::search(Position& p, Depth depth, Depth ply, Value alpha, Value bet
   return bestNodeValue;
 }
 
-Value Search::qsearch(Position& p, Depth ply, Value alpha, Value beta, Search::Node_Type isPv) {
-  //  LOG__DEBUG(Logger::get().SEARCH_LOG, "QSearch {} {}", ply, str(statistics.currentVariation));
+template<Search::Node_Type NT>
+Value Search::qsearch(Position& p, Depth ply, Value alpha, Value beta) {
+  //  LOG__DEBUG(Logger::get().SEARCH_LOG, "QSearch {}", ply);
+
+  constexpr bool isPv = NT == PV;
 
   if (statistics.currentExtraSearchDepth < ply) {
     statistics.currentExtraSearchDepth = ply;
@@ -1149,21 +1286,22 @@ Value Search::qsearch(Position& p, Depth ply, Value alpha, Value beta, Search::N
   Value staticEval    = VALUE_NONE;
 
   // TT Lookup
-  const TT::Entry* ttEntryPtr;
+  std::optional<TT::Entry> ttEntry;
   if (SearchConfig::USE_TT && SearchConfig::USE_QS_TT) {
-    ttEntryPtr = tt->probe(p.getZobristKey());
-    if (ttEntryPtr) {// tt hit
+    ttEntry = tt->probe(p.getZobristKey());
+    if (ttEntry) {// tt hit
       statistics.ttHit++;
-      ttMove              = static_cast<Move>(ttEntryPtr->move);
-      const Value ttValue = valueFromTt(ttEntryPtr->value, ply);
-      if (validValue(ttValue) && (ttEntryPtr->type == EXACT || (ttEntryPtr->type == ALPHA && ttValue <= alpha) || (ttEntryPtr->type == BETA && ttValue >= beta)) && SearchConfig::USE_TT_VALUE) {
+      // verify the move as the entry might belong to a different position with the same key bits
+      ttMove              = p.isPseudoLegalMove(static_cast<Move>(ttEntry->move)) ? static_cast<Move>(ttEntry->move) : MOVE_NONE;
+      const Value ttValue = valueFromTt(ttEntry->value, ply);
+      if (validValue(ttValue) && (ttEntry->type == EXACT || (ttEntry->type == ALPHA && ttValue <= alpha) || (ttEntry->type == BETA && ttValue >= beta)) && SearchConfig::USE_TT_VALUE) {
         statistics.TtCuts++;
         return ttValue;
       }
       // if we have a static eval stored we can reuse it
-      if (SearchConfig::USE_EVAL_TT && ttEntryPtr->eval != VALUE_NONE) {
+      if (SearchConfig::USE_EVAL_TT && ttEntry->eval != VALUE_NONE) {
         statistics.evalFromTT++;
-        staticEval = ttEntryPtr->eval;
+        staticEval = ttEntry->eval;
       }
     }
     else {
@@ -1200,13 +1338,11 @@ Value Search::qsearch(Position& p, Depth ply, Value alpha, Value beta, Search::N
 
   // reset search
   const auto myMg = &mg[ply];
-  myMg->resetOnDemand();
-  pv[ply].clear();
+  pv.clear(ply);
 
   // PV Move Sort
   if (SearchConfig::USE_TT_PV_MOVE_SORT && ttMove != MOVE_NONE) {
     statistics.TtMoveUsed++;
-    myMg->setPV(ttMove);
   }
   else {
     statistics.NoTtMove++;
@@ -1219,10 +1355,11 @@ Value Search::qsearch(Position& p, Depth ply, Value alpha, Value beta, Search::N
 
   // when in check generate all moves
   const GenMode genMode = hasCheck ? GenAll : GenNonQuiet;
+  MovePicker picker     = createMovePicker(p, ply, genMode, hasCheck, ttMove);
 
   // ///////////////////////////////////////////////////////
   // MOVE LOOP
-  while ((move = myMg->getNextPseudoLegalMove(p, genMode, hasCheck)) != MOVE_NONE) {
+  while ((move = picker.next()) != MOVE_NONE) {
     const Square from     = fromSquare(move);
     const Square to       = toSquare(move);
     const bool givesCheck = p.givesCheck(move);
@@ -1255,7 +1392,9 @@ Value Search::qsearch(Position& p, Depth ply, Value alpha, Value beta, Search::N
     // DO MOVE
     p.doMove(move);
 
-    if (!p.wasLegalMove()) {
+    // moves from a legal move picker need no test after the move
+    assert((!picker.isLegalOnly() || p.wasLegalMove()) && "move picker returned illegal move");
+    if (!picker.isLegalOnly() && !p.wasLegalMove()) {
       p.undoMove();
       continue;
     }
@@ -1267,19 +1406,18 @@ Value Search::qsearch(Position& p, Depth ply, Value alpha, Value beta, Search::N
 
     // we only count legal moves
     nodesVisited++;
-    statistics.currentVariation.push_back(move);
-    sendSearchUpdateToUci();
+    currentLine[ply] = move;
+    sendSearchUpdateToUci(ply);
 
     // check repetition and 50 moves
     if (checkDrawRepAnd50(p, 2)) {
       value = VALUE_DRAW;
     }
     else {
-      value = -qsearch(p, ply + 1, -beta, -alpha, isPv);
+      value = -qsearch<NT>(p, ply + 1, -beta, -alpha);
     }
 
     movesSearched++;
-    statistics.currentVariation.pop_back();
     p.undoMove();
     // UNDO MOVE
     // ///////////////////////////////////////////////////////
@@ -1314,7 +1452,7 @@ Value Search::qsearch(Position& p, Depth ply, Value alpha, Value beta, Search::N
           ttType = BETA;
           break;
         }
-        savePV(move, pv[ply + 1], pv[ply]);
+        pv.save(ply, move);
         alpha  = value;
         ttType = EXACT;
       }
@@ -1362,6 +1500,21 @@ inline Value Search::evaluate(Position& p) {
   return evaluator->evaluate(p);
 }
 
+MovePicker Search::createMovePicker(Position& p, Depth ply, GenMode genMode, bool hasCheck, Move ttMove) {
+  Move counterMove = MOVE_NONE;
+  if (SearchConfig::USE_HISTORY_MOVES) {
+    const Move lastMove = p.getLastMove();
+    if (lastMove != MOVE_NONE) {
+      counterMove = history.counterMoves[fromSquare(lastMove)][toSquare(lastMove)];
+    }
+  }
+  return MovePicker(p, genMode, hasCheck,
+                    SearchConfig::USE_TT_PV_MOVE_SORT ? ttMove : MOVE_NONE,
+                    mg[ply].getKillerMoves(), counterMove,
+                    SearchConfig::USE_HISTORY_COUNTER ? &history : nullptr,
+                    SearchConfig::USE_LEGAL_MOVE_GEN);
+}
+
 bool Search::goodCapture(Position& p, Move move) {
   if (SearchConfig::USE_QS_SEE) {
     // Check SEE score of higher value pieces to low value pieces
@@ -1389,12 +1542,6 @@ void Search::storeTt(Position& p, Depth depth, Depth ply, Move move, Value value
   tt->put(p.getZobristKey(), depth, move, valueToTt(value, ply), valueType, eval);
 }
 
-void Search::savePV(Move move, MoveList& src, MoveList& dest) {
-  dest.clear();
-  dest.push_back(move);
-  dest.insert(dest.end(), src.begin(), src.end());
-}
-
 Value Search::valueToTt(Value value, Depth ply) {
   if (isCheckMateValue(value)) {
     if (value > 0) {
@@ -1416,13 +1563,14 @@ Value Search::valueFromTt(Value value, Depth ply) {
 }
 
 
-void Search::getPvLine(Position& p, MoveList& pvList, Depth depth) {
+void Search::getPvLine(Position& p, Depth ply, Depth depth) {
   // Recursion-less reading of the chain of pv moves
-  pvList.clear();
+  pv.clear(ply);
   int counter  = 0;
   auto ttMatch = tt->getMatch(p.getZobristKey());
-  while (ttMatch != nullptr && ttMatch->move != MOVE_NONE && counter < depth) {
-    pvList.push_back(static_cast<Move>(ttMatch->move));
+  while (ttMatch && ttMatch->move != MOVE_NONE && counter < depth
+         && p.isPseudoLegalMove(static_cast<Move>(ttMatch->move)) && p.isLegalMove(static_cast<Move>(ttMatch->move))) {
+    pv.push_back(ply, static_cast<Move>(ttMatch->move));
     p.doMove(static_cast<Move>(ttMatch->move));
     counter++;
     ttMatch = tt->getMatch(p.getZobristKey());
@@ -1455,7 +1603,7 @@ void Search::initialize() {
   // init transposition table
   if (SearchConfig::USE_TT) {
     if (tt->getMaxNumberOfEntries() == 0) {// only initialize once
-      tt = std::make_unique<TT>(SearchConfig::TT_SIZE_MB);
+      tt = std::make_unique<TT>(SearchConfig::TT_SIZE_MB, SearchConfig::TT_COMPACT);
     }
   }
   else {
@@ -1471,7 +1619,18 @@ void Search::initialize() {
 
 bool Search::stopConditions() {
   if (stopSearchFlag) return true;
-  if (searchLimits.nodes > 0 && nodesVisited >= searchLimits.nodes) {
+  // check the deadline every TIME_CHECK_NODES nodes (well below 1ms)
+  if (nodesVisited >= nextTimeCheckNodes) {
+    nextTimeCheckNodes = nodesVisited + TIME_CHECK_NODES;
+    // helpers publish their node count for the node limit of the main search
+    if (helperId) helperNodes = nodesVisited;
+    const TimePoint d  = deadline.load(std::memory_order_relaxed);
+    if (d != TimePoint::max() && currentTime() >= d) {
+      stopSearchFlag = true;
+    }
+  }
+  // the node limit applies to the nodes of all threads
+  if (searchLimits.nodes > 0 && getTotalNodes() >= searchLimits.nodes) {
     stopSearchFlag = true;
   }
   return stopSearchFlag;
@@ -1561,28 +1720,59 @@ milliseconds Search::setupTimeControl(Position& position, SearchLimits& sl) {
 
 void Search::addExtraTime(double f) {
   if (searchLimits.timeControl && !searchLimits.moveTime.count()) {
-    auto duration = uint64_t(timeLimit.count() * (f - 1.0));
+    auto duration = int64_t(timeLimit.count() * (f - 1.0));
     extraTime += milliseconds(duration);
+    updateDeadline();
     LOG__DEBUG(Logger::get().SEARCH_LOG, "Time added/reduced by {} to {} ", str(milliseconds(duration)), str(timeLimit + extraTime));
   }
 }
 
 void Search::startTimer() {
-  this->timerThread = std::thread([&] {
+  // a previous timer (e.g. from ponderhit) has to end before a new one starts
+  if (timerWorker) timerWorker->wait();
+  {
+    std::lock_guard<std::mutex> lock(timerMutex);
     startSearchTime = currentTime();
-    LOG__DEBUG(Logger::get().SEARCH_LOG, "Timer started with time limit of {} ms", str(timeLimit));
-    // relaxed busy wait
-    while ((currentTime() - startSearchTime) < (timeLimit + extraTime) && !stopSearchFlag) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(5));
-    }
-    if (!this->stopSearchFlag) {
-      this->stopSearchFlag = true;
-      LOG__INFO(Logger::get().SEARCH_LOG, "Stop search by Timer after wall time: {} (time limit {} and extra time {})", str(currentTime() - startTime), str(timeLimit), str(extraTime));
-    }
-  });
+    deadline        = startSearchTime + timeLimit + extraTime;
+    timerRunning    = true;
+  }
+  if (!timerWorker) timerWorker = std::make_unique<Worker>([this] { runTimer(); });
+  timerWorker->start();
+}
+
+void Search::runTimer() {
+  LOG__DEBUG(Logger::get().SEARCH_LOG, "Timer started with time limit of {} ms", str(timeLimit));
+  std::unique_lock<std::mutex> lock(timerMutex);
+  // wait until the deadline - a changed deadline wakes us up to wait again
+  while (!stopSearchFlag && currentTime() < deadline.load()) {
+    timerCondition.wait_until(lock, deadline.load());
+  }
+  timerRunning = false;
+  lock.unlock();
+  if (!this->stopSearchFlag) {
+    this->stopSearchFlag = true;
+    LOG__INFO(Logger::get().SEARCH_LOG, "Stop search by Timer after wall time: {} (time limit {} and extra time {})", str(currentTime() - startTime), str(timeLimit), str(extraTime));
+  }
+}
+
+void Search::updateDeadline() {
+  {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    // without a running timer the deadline is set when the timer starts
+    if (!timerRunning) return;
+    deadline = startSearchTime + timeLimit + extraTime;
+  }
+  timerCondition.notify_all();
+}
+
+void Search::notifyTimer() {
+  // the empty lock makes sure the timer is either waiting or will see the stop flag
+  { std::lock_guard<std::mutex> lock(timerMutex); }
+  timerCondition.notify_all();
 }
 
 void Search::sendReadyOk() const {
+  if (helperId) return;
   if (uciHandler) {
     uciHandler->sendReadyOk();
     return;
@@ -1591,6 +1781,7 @@ void Search::sendReadyOk() const {
 }
 
 void Search::sendString(const std::string& msg) const {
+  if (helperId) return;
   if (uciHandler) {
     uciHandler->sendString(msg);
     return;
@@ -1605,17 +1796,19 @@ void Search::sendResult(SearchResult& result) {
 }
 
 void Search::sendIterationEndInfoToUci() {
+  if (helperId) return;
   const nanoseconds& since = elapsedSince(startSearchTime);
+  const uint64_t totalNodes = getTotalNodes();
   lastUciUpdateTime        = nowFast();
   if (uciHandler) {
     uciHandler->sendIterationEndInfo(
       statistics.currentSearchDepth,
       statistics.currentExtraSearchDepth,
       statistics.currentBestRootMoveValue,
-      nodesVisited,
-      nps(nodesVisited, since),
+      totalNodes,
+      nps(totalNodes, since),
       MILLISECONDS(since),
-      pv[0]);
+      pv.line(0));
     return;
   }
 
@@ -1623,13 +1816,13 @@ void Search::sendIterationEndInfoToUci() {
             statistics.currentSearchDepth,
             statistics.currentExtraSearchDepth,
             str(statistics.currentBestRootMoveValue),
-            nodesVisited,
-            nps(nodesVisited, since),
+            totalNodes,
+            nps(totalNodes, since),
             MILLISECONDS(since).count(),
-            str(pv[0]));
+            str(pv.line(0)));
 }
 
-void Search::sendSearchUpdateToUci() {
+void Search::sendSearchUpdateToUci(Depth ply) {
 
   // to minimize performance impact we only check time every 1M nodes
   if ((nodesVisited - lastUciUpdateNodes < 1'000'000)) {
@@ -1637,6 +1830,9 @@ void Search::sendSearchUpdateToUci() {
   }
   lastUciUpdateNodes = nodesVisited;
 
+  // helpers publish their node count in stopConditions()
+  if (helperId) return;
+
   // we only update every UCI_UPDATE_INTERVAL ns
   const uint64_t nowTime = nowFast();
   if (nowTime - lastUciUpdateTime < UCI_UPDATE_INTERVAL) {
@@ -1647,10 +1843,12 @@ void Search::sendSearchUpdateToUci() {
   // nps is calculated from the nodes and time since last update.
   // This might not be the same as the over all avg. nps which is shown
   // at the end of a search.
-  const uint64_t nodesPerSec = nps(nodesVisited - npsNodes, nowTime - npsTime);
+  const uint64_t totalNodes  = getTotalNodes();
+  const uint64_t nodesPerSec = nps(totalNodes - npsNodes, nowTime - npsTime);
   npsTime                    = nowTime;
-  npsNodes                   = nodesVisited;
+  npsNodes                   = totalNodes;
 
+  // sampled from the first clusters of the TT - cheap and safe to call
   const int hashfull = tt->hashFull();
 
   const nanoseconds& since = elapsedSince(startSearchTime);
@@ -1659,36 +1857,46 @@ void Search::sendSearchUpdateToUci() {
     uciHandler->sendSearchUpdate(
       statistics.currentSearchDepth,
       statistics.currentExtraSearchDepth,
-      nodesVisited,
+      totalNodes,
       nodesPerSec,
       MILLISECONDS(since),
       hashfull);
     uciHandler->sendCurrentRootMove(statistics.currentRootMove, statistics.currentRootMoveIndex);
-    uciHandler->sendCurrentLine(statistics.currentVariation);
+    // the current line is only reconstructed when the GUI asked for it
+    if (SearchConfig::UCI_SHOW_CURR_LINE) {
+      MoveList line{};
+      for (int i = 0; i <= ply; ++i) {
+        if (currentLine[i] != MOVE_NONE) line.push_back(currentLine[i]);// skip null moves
+      }
+      uciHandler->sendCurrentLine(line);
+    }
+    uciHandler->flush();
     return;
   }
 
   LOG__INFO(Logger::get().SEARCH_LOG, "depth {} seldepth {} nodes {:L} nps {:L} time {:L} hashful {:L}",
             statistics.currentSearchDepth,
             statistics.currentExtraSearchDepth,
-            nodesVisited,
+            totalNodes,
             nodesPerSec,
             MILLISECONDS(since).count(),
             hashfull);
 }
 
 void Search::sendAspirationResearchInfo(const std::string& boundString) {
+  if (helperId) return;
   const nanoseconds& since = elapsedSince(startSearchTime);
+  const uint64_t totalNodes = getTotalNodes();
   if (uciHandler) {
     uciHandler->sendAspirationResearchInfo(
       statistics.currentSearchDepth,
       statistics.currentExtraSearchDepth,
       statistics.currentBestRootMoveValue,
       boundString,
-      nodesVisited,
-      nps(nodesVisited, since),
+      totalNodes,
+      nps(totalNodes, since),
       MILLISECONDS(since),
-      pv[0]);
+      pv.line(0));
     return;
   }
 
@@ -1697,8 +1905,8 @@ void Search::sendAspirationResearchInfo(const std::string& boundString) {
             statistics.currentExtraSearchDepth,
             str(statistics.currentBestRootMoveValue),
             boundString,
-            nodesVisited,
-            nps(nodesVisited, since),
+            totalNodes,
+            nps(totalNodes, since),
             MILLISECONDS(since).count(),
-            str(pv[0]));
+            str(pv.line(0)));
 }
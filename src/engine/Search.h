@@ -20,6 +20,8 @@
 #ifndef FRANKYCPP_SEARCH_H
 #define FRANKYCPP_SEARCH_H
 
+#include "MovePicker.h"
+#include "PvTable.h"
 #include "SearchLimits.h"
 #include "SearchResult.h"
 #include "SearchStats.h"
@@ -28,13 +30,18 @@
 #include "chesscore/MoveGenerator.h"
 #include "chesscore/Position.h"
 #include "common/Semaphore.h"
+#include "common/Worker.h"
 #include "engine/UciHandler.h"
 #include "openingbook/OpeningBook.h"
 #include "types/types.h"
 
 #include "gtest/gtest_prod.h"
 
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 // forward declaration
 class UciHandler;
@@ -48,12 +55,34 @@ class Search {
   // state management for the search
   mutable Semaphore initSemaphore{1};
   mutable Semaphore isRunningSemaphore{1};
-  std::thread searchThread{};
+
+  // The search, the timer and the helpers run on persistent worker threads.
+  // They are created once when first needed and are then parked on the
+  // worker's condition variable until the next search is started. This
+  // avoids creating and joining threads and allocating tasks for every "go".
+  // The search worker runs run() - for helpers it runs runHelper().
+  std::unique_ptr<Worker> searchWorker{};
 
   std::unique_ptr<OpeningBook> book;
-  std::unique_ptr<TT> tt;
+  std::shared_ptr<TT> tt;
   std::unique_ptr<Evaluator> evaluator;
 
+  // true from loading the TT from a hash file until the next search - a
+  // persistent hash is then kept when a new game starts
+  bool ttLoaded = false;
+
+  // Lazy SMP helper searches. Each helper is a search instance of its own
+  // with its own position, move generators, pv and history but all share
+  // the transposition table with this (main) search. Only the main search
+  // reports to the uci handler and determines the result.
+  std::vector<std::unique_ptr<Search>> helpers{};
+  int helperId = 0;// 0 for the main search
+  // nodes visited by a helper - published every TIME_CHECK_NODES for the main search
+  std::atomic<uint64_t> helperNodes{};
+  // iterations skipped by helpers to distribute them over different depths
+  constexpr static int SKIP_SIZE[20]  = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+  constexpr static int SKIP_PHASE[20] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
   // history heuristics
   History history{};
 
@@ -74,7 +103,18 @@ class Search {
   TimePoint startSearchTime;// actual start time of search - only different from startTime after ponderhit()
   milliseconds timeLimit{};
   milliseconds extraTime{};
-  std::thread timerThread{};
+  std::unique_ptr<Worker> timerWorker{};
+
+  // The timer waits on the condition variable until the deadline is reached.
+  // It is notified when the deadline changes (re-arm) or the search stops.
+  // The search also checks the deadline itself every TIME_CHECK_NODES nodes
+  // so it stops in time even if the timer thread is woken late.
+  std::mutex timerMutex{};
+  std::condition_variable timerCondition{};
+  bool timerRunning = false;// guarded by timerMutex
+  std::atomic<TimePoint> deadline{TimePoint::max()};
+  constexpr static uint64_t TIME_CHECK_NODES = 1'024;
+  uint64_t nextTimeCheckNodes{};
 
   // Control UCI updates to avoid flooding
   constexpr static uint64_t UCI_UPDATE_INTERVAL = nanoPerSec;
@@ -90,9 +130,13 @@ class Search {
   SearchStats statistics{};
 
   // ply related data
-  std::array<MoveList, DEPTH_MAX> pv{};
+  PvTable pv{};
   std::array<MoveGenerator, DEPTH_MAX> mg{};
 
+  // the move searched at each ply of the current line (root move at 0)
+  // only read to send the current line to the UCI GUI (UCI_ShowCurrLine)
+  std::array<Move, MAX_DEPTH> currentLine{};
+
   // to mark the last move was a book move
   bool hadBookMove = false;
 
@@ -120,6 +164,12 @@ public:
 
   ~Search();
 
+private:
+  // Creates a Lazy SMP helper search sharing the given TT.
+  Search(std::shared_ptr<TT> sharedTT, int id);
+
+public:
+
   // disallow copies and moves
   Search(Search const&) = delete;
   Search& operator=(const Search&) = delete;
@@ -141,7 +191,7 @@ public:
   // set in SetUciHandler to send "readyok" to the UCI user interface.
   void isReady();
 
-  // starts the search in a separate thread with the given search limits
+  // starts the search on the search worker thread with the given search limits
   void startSearch(Position p, SearchLimits sl);
 
   // Stops a running search gracefully - e.g. returns the best move found so far
@@ -161,7 +211,7 @@ public:
   void ponderhit();
 
   // return current root pv list
-  const MoveList& getPV() const { return pv[0]; };// TODO implement
+  MoveList getPV() const { return pv.line(0); };
 
   // clears the hash table
   void clearTT();
@@ -169,6 +219,19 @@ public:
   // resize the hash to the value in the global config SearchConfig::TT_SIZE_MB
   void resizeTT();
 
+  // saves the hash to the given file
+  void saveTT(const std::string& path);
+
+  // replaces the hash with the content of the given file
+  void loadTT(const std::string& path);
+
+  // true if the hash was loaded from a file and has not been cleared or
+  // searched with since
+  bool isTTLoaded() const { return ttLoaded; }
+
+  // true if the hash is kept for a new game (loaded hash and Persistent Hash on)
+  bool keepTTForNewGame() const;
+
   // return search stats instance
   inline const SearchStats& getSearchStats() const { return statistics; }// TODO implement
 
@@ -184,12 +247,29 @@ private:
   // This can be called several times without doing
   // initialization again.
   void initialize();
+  FRIEND_TEST(UCITest, newGameKeepsPersistentHash);
 
   // Called after starting the search in a new thread. Configures the search
   // and eventually calls iterativeDeepening. After the search it takes the
   // result to sends it to the UCI engine.
   void run();
 
+  // startHelpers starts SearchConfig::THREADS - 1 helper searches
+  // on copies of the current position. Helpers search until stopped
+  // or until they reach the depth limit.
+  void startHelpers();
+
+  // stopHelpers signals all running helper searches to stop and waits
+  // until they have finished.
+  void stopHelpers();
+
+  // runHelper is the thread function of a helper search. It prepares the
+  // per thread data and runs iterative deepening on the helper's position.
+  void runHelper();
+
+  // total number of nodes visited by the main search and all helpers
+  uint64_t getTotalNodes() const;
+
   // Iterative Deepening:
   // It works as follows: the program starts with a one ply search,
   // then increments the search depth and does another search. This
@@ -220,7 +300,10 @@ private:
   // enter quiescence search. Search consumes about 60% of the search time and
   // all major prunings are done here. Quiescence search uses about 40% of the
   // search time and has less options for pruning as not all moves are searched.
-  Value search(Position& p, Depth depth, Depth ply, Value alpha, Value beta, Node_Type isPv, Do_Null doNull);
+  // The node type and the null move permission are template parameters so
+  // each of the variants is compiled with its own dead branches removed.
+  template<Node_Type NT, Do_Null DN>
+  Value search(Position& p, Depth depth, Depth ply, Value alpha, Value beta);
 
   // qsearch is a simplified search to counter the horizon effect in depth based
   // searches. It continues the search into deeper branches as long as there are
@@ -230,7 +313,8 @@ private:
   // Look for non quiet moves is supported be the move generator which only
   // generates captures or promotions in qsearch (when not in check) and also
   // by SEE (Static Exchange Evaluation) to determine winning captured sequences.
-  Value qsearch(Position& p, Depth ply, Value alpha, Value beta, Node_Type isPv);
+  template<Node_Type NT>
+  Value qsearch(Position& p, Depth ply, Value alpha, Value beta);
 
   // After expanding the search to the required depth and all non quiet moves were
   // generated call the evaluation heuristic on the position.
@@ -242,12 +326,13 @@ private:
   // to only look at good captures.
   bool goodCapture(Position& position, Move move);
 
+  // creates the move picker for a node with the tt move, the killer moves
+  // of the ply, the counter move and the history data as configured
+  MovePicker createMovePicker(Position& p, Depth ply, GenMode genMode, bool hasCheck, Move ttMove);
+
   // storeTT stores a position into the TT
   void storeTt(Position& p, Depth depth, Depth ply, Move move, Value value, ValueType valueType, Value eval);
 
-  // savePV adds the given move as first move to a dest move list and the appends
-  // all src moves to dest. Dest will be cleared before the the append.
-  static void savePV(Move move, MoveList& src, MoveList& dest);
 
   // correct the value for mate distance when storing to TT
   static Value valueToTt(Value value, Depth ply);
@@ -255,11 +340,11 @@ private:
   // correct the value for mate distance when reading from TT
   static Value valueFromTt(Value value, Depth ply);
 
-  // getPVLine fills the given pv move list with the pv move starting from the given
-  // depth as long as these position are in the TT
+  // getPVLine fills the pv row of the given ply with the pv moves starting from the given
+  // position as long as these position are in the TT (max depth moves)
   // This is used when we retrieve a value and move from the TT and would not get a PV
   // line otherwise.
-  void getPvLine(Position& p, MoveList& pvList, Depth depth);
+  void getPvLine(Position& p, Depth ply, Depth depth);
 
   // stopConditions checks if stopFlag is set or if nodesVisited have
   // reached a potential maximum set in the search limits.
@@ -284,11 +369,24 @@ private:
   void addExtraTime(double f);
   FRIEND_TEST(SearchTest, extraTime);
 
-  // startTimer starts a thread which regularly checks the elapsed time against
-  // the time limit and extra time given. If time limit is reached this will set
-  // the stopFlag to true and terminate itself.
+  // startTimer sets the deadline from the time limit and extra time given and
+  // starts the timer on the timer worker thread. The timer sleeps until the
+  // deadline or until it is notified. If the deadline is reached this will
+  // set the stopFlag to true and end the timer.
   void startTimer();
   FRIEND_TEST(SearchTest, startTimer);
+  FRIEND_TEST(SearchTest, timerReArm);
+  FRIEND_TEST(SearchTest, timeOverrun);
+
+  // the timer job run by the timer worker
+  void runTimer();
+
+  // updateDeadline re-calculates the deadline of a running timer after the
+  // extra time has changed and wakes the timer to wait for the new deadline.
+  void updateDeadline();
+
+  // notifyTimer wakes up the timer so it can end after stopSearchFlag is set.
+  void notifyTimer();
 
   // checks repetitions and 50-moves rule. Returns true if the position
   // has repeated itself at least the given number of times.
@@ -307,7 +405,7 @@ private:
   void sendIterationEndInfoToUci();
 
   // send UCI information about search - could be called each 500ms or so.
-  void sendSearchUpdateToUci();
+  void sendSearchUpdateToUci(Depth ply);
 
   // send UCI information after aspiration search.
   void sendAspirationResearchInfo(const std::string& boundString);
@@ -23,6 +23,8 @@
 #include "openingbook/OpeningBook.h"
 #include "types/types.h"
 
+// Features and parameters declared CONFIG_FEATURE are compile time
+// constants in a tournament build (see types/macros.h).
 namespace SearchConfig {
 
   // opening book
@@ -32,50 +34,67 @@ namespace SearchConfig {
 
   inline bool USE_PONDER = true;
 
+  // send the currently searched line to the UCI GUI (UCI_ShowCurrLine)
+  inline bool UCI_SHOW_CURR_LINE = false;
+
+  // number of search threads - additional threads are used
+  // as Lazy SMP helpers sharing the transposition table
+  inline int THREADS = 1;
+
   // basic search strategies and features
-  inline bool USE_ALPHABETA = true;// use ALPHABETA pruning
-  inline bool USE_PVS       = true;// use PVS null window search
-  inline bool USE_ASP       = true;// use Aspiration Window search
+  CONFIG_FEATURE bool USE_ALPHABETA = true;// use ALPHABETA pruning
+  CONFIG_FEATURE bool USE_PVS       = true;// use PVS null window search
+  CONFIG_FEATURE bool USE_ASP       = true;// use Aspiration Window search
 
   // quiescence search
-  inline bool USE_QUIESCENCE = true;// use quiescence search
+  CONFIG_FEATURE bool USE_QUIESCENCE = true;// use quiescence search
 
   // Transposition Table
-  inline bool USE_TT       = true;// use transposition table
-  inline bool USE_TT_VALUE = true;// use value from tt to prune
-  inline bool USE_EVAL_TT  = true;// use value from tt for storing evaluations
-  inline int TT_SIZE_MB    = 64;  // size of TT in MB
-  inline bool USE_QS_TT    = true;// use transposition table also in quiescence search
+  CONFIG_FEATURE bool USE_TT       = true;// use transposition table
+  CONFIG_FEATURE bool USE_TT_VALUE = true;// use value from tt to prune
+  CONFIG_FEATURE bool USE_EVAL_TT  = true;// use value from tt for storing evaluations
+  CONFIG_FEATURE bool USE_QS_TT    = true;// use transposition table also in quiescence search
+  inline int TT_SIZE_MB            = 64;   // size of TT in MB
+  inline bool TT_COMPACT           = false;// use compact 10 byte entries (50% more entries per MB)
+
+  // memory for the transposition tables (TT and PawnTT)
+  inline bool USE_LARGE_PAGES     = true; // use huge pages if available (Linux)
+  inline bool USE_NUMA_INTERLEAVE = false;// interleave pages over NUMA nodes instead of first touch
+
+  // persistent transposition table
+  inline std::string TT_FILE   = "./FrankyCPP.hash";// file for saving and loading the TT
+  inline bool TT_PERSISTENT    = false;             // load TT when enabled and save it on quit
 
   // Move Sorting Features
-  inline bool USE_TT_PV_MOVE_SORT = true;// use move from tt as pv
-  inline bool USE_KILLER_MOVES    = true;// Store refutation moves (>beta) for move ordering
-  inline bool USE_HISTORY_COUNTER = true;
-  inline bool USE_HISTORY_MOVES   = true;
-  inline bool USE_IID             = true;// Internal iterative deepening
-  inline Depth IID_DEPTH{6};             // Internal iterative deepening
-  inline Depth IID_REDUCTION{2};         // Internal iterative deepening
+  CONFIG_FEATURE bool USE_TT_PV_MOVE_SORT = true;// use move from tt as pv
+  CONFIG_FEATURE bool USE_KILLER_MOVES    = true;// Store refutation moves (>beta) for move ordering
+  CONFIG_FEATURE bool USE_HISTORY_COUNTER = true;
+  CONFIG_FEATURE bool USE_HISTORY_MOVES   = true;
+  CONFIG_FEATURE bool USE_LEGAL_MOVE_GEN  = true;// move picker only returns legal moves (pin and checker masks)
+  CONFIG_FEATURE bool USE_IID             = true;// Internal iterative deepening
+  CONFIG_FEATURE Depth IID_DEPTH{6};             // Internal iterative deepening
+  CONFIG_FEATURE Depth IID_REDUCTION{2};         // Internal iterative deepening
 
   // Pruning features
-  inline bool USE_MDP             = true;// mate distance pruning
-  inline bool USE_QS_STANDPAT_CUT = true;
-  inline bool USE_QS_SEE          = true;// use SEE for goodCaptures
-  inline bool USE_RAZORING        = true;// Razoring like Stockfish
-  inline Value RAZOR_MARGIN{531};
-  inline bool USE_RFP        = true;                                          // Reverse Futility Pruning
-  inline Value RFP_MARGIN[4] = {Value{0}, Value{200}, Value{400}, Value{800}};// reverse futility pruning - array with margins per depth left
-
-  inline bool USE_NMP        = true;// Null Move Pruning
-  inline Depth NMP_DEPTH     = Depth{3};
-  inline Depth NMP_REDUCTION = Depth{2};
-
-  inline bool USE_FP        = true;                                                                               // futility pruning
-  inline bool USE_QFP       = true;                                                                               // futility pruning qsearch
-  inline Value FP_MARGIN[7] = {Value{0}, Value{100}, Value{200}, Value{300}, Value{500}, Value{900}, Value{1200}};// futility pruning - array with margins per depth left.
-
-  inline bool USE_LMR                 = true;// Late Move Reduction
-  inline Depth LMR_MIN_DEPTH          = Depth{3};
-  inline int LMR_MIN_MOVES            = 3;
+  CONFIG_FEATURE bool USE_MDP             = true;// mate distance pruning
+  CONFIG_FEATURE bool USE_QS_STANDPAT_CUT = true;
+  CONFIG_FEATURE bool USE_QS_SEE          = true;// use SEE for goodCaptures
+  CONFIG_FEATURE bool USE_RAZORING        = true;// Razoring like Stockfish
+  CONFIG_FEATURE Value RAZOR_MARGIN{531};
+  CONFIG_FEATURE bool USE_RFP        = true;                                          // Reverse Futility Pruning
+  CONFIG_FEATURE Value RFP_MARGIN[4] = {Value{0}, Value{200}, Value{400}, Value{800}};// reverse futility pruning - array with margins per depth left
+
+  CONFIG_FEATURE bool USE_NMP        = true;// Null Move Pruning
+  CONFIG_FEATURE Depth NMP_DEPTH     = Depth{3};
+  CONFIG_FEATURE Depth NMP_REDUCTION = Depth{2};
+
+  CONFIG_FEATURE bool USE_FP        = true;                                                                               // futility pruning
+  CONFIG_FEATURE bool USE_QFP       = true;                                                                               // futility pruning qsearch
+  CONFIG_FEATURE Value FP_MARGIN[7] = {Value{0}, Value{100}, Value{200}, Value{300}, Value{500}, Value{900}, Value{1200}};// futility pruning - array with margins per depth left.
+
+  CONFIG_FEATURE bool USE_LMR         = true;// Late Move Reduction
+  CONFIG_FEATURE Depth LMR_MIN_DEPTH  = Depth{3};
+  CONFIG_FEATURE int LMR_MIN_MOVES    = 3;
   constexpr int LMR_REDUCTION[32][64] = {
     // pre-computed array int(math.Round(((float64(depth) * 0.7) * (float64(movesSearched) * 0.005)) + 1.0))
     {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
@@ -109,13 +128,13 @@ namespace SearchConfig {
     {1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 8, 8, 8},
   };
 
-  inline bool USE_LMP         = true;// Late Move Pruning (pre-computed with 6 + int(math.Pow(float64(i)+0.5, 1.3)))
+  CONFIG_FEATURE bool USE_LMP = true;// Late Move Pruning (pre-computed with 6 + int(math.Pow(float64(i)+0.5, 1.3)))
   constexpr int LMP_MOVES[16] = {0, 7, 9, 11, 13, 15, 17, 19, 22, 24, 27, 29, 32, 35, 38, 41};
 
-  inline bool USE_EXTENSIONS    = true;
-  inline bool USE_CHECK_EXT     = true;
-  inline bool USE_THREAT_EXT    = false;
-  inline bool USE_EXT_ADD_DEPTH = true;
+  CONFIG_FEATURE bool USE_EXTENSIONS    = true;
+  CONFIG_FEATURE bool USE_CHECK_EXT     = true;
+  CONFIG_FEATURE bool USE_THREAT_EXT    = false;
+  CONFIG_FEATURE bool USE_EXT_ADD_DEPTH = true;
 
 }// namespace SearchConfig
 
@@ -34,7 +34,6 @@ struct SearchStats {
   Move currentBestRootMove;
   Value currentBestRootMoveValue;
 
-  MoveList currentVariation{};
   size_t currentRootMoveIndex;
   Move currentRootMove;
 
@@ -18,16 +18,22 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <new>
 #include <thread>
 #include <vector>
 
+#include "SearchConfig.h"
 #include "TT.h"
 #include "common/Logging.h"
 
-TT::TT(uint64_t newSizeInMByte) {
+TT::TT(uint64_t newSizeInMByte, bool compactEntries) {
   noOfThreads = std::thread::hardware_concurrency();
+  compact     = compactEntries;
   resize(newSizeInMByte);
 }
 
@@ -41,34 +47,37 @@ void TT::resize(const uint64_t newSizeInMByte) {
     sizeInByte = newSizeInMByte * MB;
   }
 
-  // find the highest power of 2 smaller than maxPossibleEntries
-  maxNumberOfEntries = (1ULL << static_cast<uint64_t>(std::floor(std::log2(sizeInByte / ENTRY_SIZE))));
-  hashKeyMask        = maxNumberOfEntries - 1;
+  // find the highest power of 2 smaller than maxPossibleClusters
+  numberOfClusters = (1ULL << static_cast<uint64_t>(std::floor(std::log2(sizeInByte / sizeof(Cluster)))));
+  hashKeyMask      = numberOfClusters - 1;
 
   // if TT is resized to 0 we cant have any entries.
-  if (sizeInByte == 0) maxNumberOfEntries = 0;
-  sizeInByte = maxNumberOfEntries * ENTRY_SIZE;
+  if (sizeInByte == 0) numberOfClusters = 0;
+  maxNumberOfEntries = numberOfClusters * getClusterSize();
+  sizeInByte         = numberOfClusters * sizeof(Cluster);
 
-  delete[] _data;
   // try to allocate memory for TT - repeat until allocation is successful
   while (true) {
     try {
-      _data = new Entry[maxNumberOfEntries];
+      _data = static_cast<Cluster*>(memory.allocate(numberOfClusters * sizeof(Cluster),
+                                                    SearchConfig::USE_LARGE_PAGES,
+                                                    SearchConfig::USE_NUMA_INTERLEAVE));
       break;
     } catch (std::bad_alloc const&) {
       // we could not allocate enough memory so we reduce TT size by a power of 2
       auto oldSize       = sizeInByte;
-      maxNumberOfEntries = maxNumberOfEntries >> 1ULL;
-      hashKeyMask        = maxNumberOfEntries - 1;
-      sizeInByte         = maxNumberOfEntries * ENTRY_SIZE;
+      numberOfClusters   = numberOfClusters >> 1ULL;
+      hashKeyMask        = numberOfClusters - 1;
+      maxNumberOfEntries = numberOfClusters * getClusterSize();
+      sizeInByte         = numberOfClusters * sizeof(Cluster);
       LOG__ERROR(Logger::get().TT_LOG, "Not enough memory for requested TT size {:L} MB reducing to {:L} MB", oldSize, sizeInByte);
     }
   }
 
   clear();
   if (maxNumberOfEntries) {
-    LOG__INFO(Logger::get().TT_LOG, "TT Size {:L} MByte, Capacity {:L} entries (size={}Byte) (Requested were {:L} MBytes)",
-              sizeInByte / MB, maxNumberOfEntries, sizeof(Entry), newSizeInMByte);
+    LOG__INFO(Logger::get().TT_LOG, "TT Size {:L} MByte, Capacity {:L} entries (size={}Byte) in {:L} clusters using {} (Requested were {:L} MBytes)",
+              sizeInByte / MB, maxNumberOfEntries, getEntrySize(), numberOfClusters, memory.str(), newSizeInMByte);
   }
 }
 
@@ -77,27 +86,25 @@ void TT::clear() {
     return;
   }
   // This clears the TT by overwriting each entry with 0.
-  // It uses multiple threads if noOfThreads is > 1.
+  // It uses multiple threads if noOfThreads is > 1. As the memory of a new
+  // table is untouched, each page is placed on the NUMA node of the
+  // thread clearing it (first touch) unless pages are interleaved.
   LOG__TRACE(Logger::get().TT_LOG, "Clearing TT ({} threads)...", noOfThreads);
 
-  auto startTime = std::chrono::high_resolution_clock::now();
+  [[maybe_unused]] auto startTime = std::chrono::high_resolution_clock::now();
   std::vector<std::thread> threads;
   threads.reserve(noOfThreads);
 
   // split work onto multiple threads
   for (unsigned int t = 0; t < noOfThreads; ++t) {
     threads.emplace_back([&, this, t]() {
-      auto range = maxNumberOfEntries / noOfThreads;
+      auto range = numberOfClusters / noOfThreads;
       auto start = t * range;
       auto end   = start + range;
-      if (t == noOfThreads - 1) end = maxNumberOfEntries;
+      if (t == noOfThreads - 1) end = numberOfClusters;
       for (std::size_t i = start; i < end; ++i) {
-        _data[i].key        = 0;
-        _data[i].move       = MOVE_NONE;
-        _data[i].depth      = DEPTH_NONE;
-        _data[i].value      = VALUE_NONE;
-        _data[i].eval       = VALUE_NONE;
-        _data[i].age        = 1;
+        if (compact) new (&_data[i]) CompactCluster();
+        else new (&_data[i]) Cluster();
       }
     });
   }
@@ -105,20 +112,10 @@ void TT::clear() {
   // wait until all threads have finished their work
   for (std::thread& th : threads) th.join();
 
-  // reset statistics
-  numberOfPuts       = 0;
-  numberOfEntries    = 0;
-  numberOfHits       = 0;
-  numberOfUpdates    = 0;
-  numberOfMisses     = 0;
-  numberOfCollisions = 0;
-  numberOfOverwrites = 0;
-  numberOfProbes     = 0;
-
-  auto finish = std::chrono::high_resolution_clock::now();
-  auto time   = std::chrono::duration_cast<std::chrono::milliseconds>(finish - startTime).count();
+  resetStatistics();
 
-  LOG__DEBUG(Logger::get().TT_LOG, "TT cleared {:L} entries in {:L} ms ({} threads)", maxNumberOfEntries, time, noOfThreads);
+  LOG__DEBUG(Logger::get().TT_LOG, "TT cleared {:L} entries in {:L} ms ({} threads)", maxNumberOfEntries,
+             std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - startTime).count(), noOfThreads);
 }
 
 void TT::put(Key key, Depth depth, Move move, Value value, ValueType type, Value eval) {
@@ -127,121 +124,240 @@ void TT::put(Key key, Depth depth, Move move, Value value, ValueType type, Value
   // do not store anything
   if (!maxNumberOfEntries) return;
 
-  // read the entries for this hash
-  Entry* entryDataPtr = getEntryPtr(key);
-
-  numberOfPuts++;
-
-  // New entry
-  if (entryDataPtr->key == 0) {
-    numberOfEntries++;
-    entryDataPtr->key        = key;
-    entryDataPtr->move       = static_cast<uint16_t>(move);
-    entryDataPtr->depth      = depth;
-    entryDataPtr->value      = value;
-    entryDataPtr->type       = type;
-    entryDataPtr->age        = 1;
-    entryDataPtr->eval       = eval;
-    return;
-  }
+  if (compact) put(*getCompactClusterPtr(key), key, depth, move, value, type, eval);
+  else put(*getClusterPtr(key), key, depth, move, value, type, eval);
+}
 
-  // Same hash but different position
-  if (entryDataPtr->key != key) {
-    numberOfCollisions++;
-    // overwrite if
-    // - the new entry's depth is higher
-    // - the new entry's depth is same and the previous entry has not been used (is aged)
-    if (depth > entryDataPtr->depth ||
-        (depth == entryDataPtr->depth && entryDataPtr->age > 0)) {
-      numberOfOverwrites++;
-      entryDataPtr->key        = key;
-      entryDataPtr->move       = static_cast<uint16_t>(move);
-      entryDataPtr->depth      = depth;
-      entryDataPtr->value      = value;
-      entryDataPtr->type       = type;
-      entryDataPtr->age        = 1;
-      entryDataPtr->eval       = eval;
+template<typename C>
+void TT::put(C& cluster, Key key, Depth depth, Move move, Value value, ValueType type, Value eval) {
+  Stats& s = threadStats();
+
+  inc(s.numberOfPuts);
+
+  // Look for the same position, an empty entry or the least valuable
+  // entry in the cluster. A torn entry (written concurrently by another
+  // thread) will not match any valid key and is treated as occupied.
+  std::size_t replaceIndex = 0;
+  int replaceValue         = std::numeric_limits<int>::max();
+  uint64_t data;
+  bool empty;
+  for (std::size_t i = 0; i < C::SIZE; ++i) {
+
+    // Same position -> update entry
+    if (cluster.read(i, key, data, empty)) {
+      inc(s.numberOfUpdates);
+      // we always update as the stored moved can't be any good otherwise
+      // we would have found this during the search in a previous probe
+      // and we would not have come to store it again
+      Entry updated = decode(key, data);
+      if (move) {// preserve existing move if no move is given
+        updated.move = static_cast<uint16_t>(move);
+      }
+      if (value != VALUE_NONE) {// preserve existing entry if no valid value is given
+        updated.depth = depth;
+        updated.value = value;
+        updated.type  = type;
+      }
+      if (eval != VALUE_NONE) {// preserve existing entry if no valid value is given
+        updated.eval = eval;
+      }
+      cluster.write(i, key, encode(static_cast<Move>(updated.move), updated.eval, updated.value, static_cast<Depth>(updated.depth), generation, updated.type));
+      return;
     }
-    return;
-  }
 
-  // Same hash and same position -> update entry?
-  if (entryDataPtr->key == key) {
-    numberOfUpdates++;
-    // we always update as the stored moved can't be any good otherwise
-    // we would have found this during the search in a previous probe
-    // and we would not have come to store it again
-    entryDataPtr->key = key;
-    if (move) {// preserve existing move if no move is given
-      entryDataPtr->move = static_cast<uint16_t>(move);
+    // New entry - entries of a cluster are filled in order and never
+    // emptied so the key can't be stored in any of the following entries
+    if (empty) {
+      cluster.write(i, key, encode(move, eval, value, depth, generation, type));
+      return;
     }
-    if (value != VALUE_NONE) {// preserve existing entry if no valid value is given
-      entryDataPtr->depth = depth;
-      entryDataPtr->value = value;
-      entryDataPtr->type  = type;
-      entryDataPtr->age   = 1;
+
+    // remember the least valuable entry
+    const Entry entry       = decode(key, data);
+    const int entryPriority = entry.depth - AGE_WEIGHT * entry.age;
+    if (entryPriority < replaceValue) {
+      replaceValue = entryPriority;
+      replaceIndex = i;
     }
-    if (eval != VALUE_NONE) {// preserve existing entry if no valid value is given
-      entryDataPtr->eval = eval;
+  }
+
+  // Cluster is full with different positions - replace
+  // the entry with the lowest depth minus age
+  inc(s.numberOfCollisions);
+  inc(s.numberOfOverwrites);
+  cluster.write(replaceIndex, key, encode(move, eval, value, depth, generation, type));
+}
+
+std::optional<TT::Entry> TT::probe(const Key& key) {
+  if (compact) return probe(*getCompactClusterPtr(key), key);
+  return probe(*getClusterPtr(key), key);
+}
+
+template<typename C>
+std::optional<TT::Entry> TT::probe(C& cluster, const Key key) {
+  Stats& s = threadStats();
+  inc(s.numberOfProbes);
+
+  uint64_t data;
+  bool empty;
+  for (std::size_t i = 0; i < C::SIZE; ++i) {
+    if (cluster.read(i, key, data, empty)) {
+      inc(s.numberOfHits);// entries with identical keys found
+      if (generationOf(data) != generation) {// mark the entry as used in this generation
+        cluster.write(i, key, refresh(data));
+      }
+      return decode(key, refresh(data));
     }
-    return;
   }
 
-  assert(numberOfPuts == (numberOfEntries + numberOfCollisions + numberOfUpdates));
+  inc(s.numberOfMisses);// keys not found (not equal to TT misses)
+  return std::nullopt;
 }
 
-const TT::Entry* TT::probe(const Key& key) {
-  numberOfProbes++;
+int TT::hashFull() const {
+  if (!maxNumberOfEntries) return 0;
+  const std::size_t clusters = std::min(HASHFULL_SAMPLE_CLUSTERS, numberOfClusters);
+  const std::size_t used     = compact ? countEntries<CompactCluster>(clusters, true) : countEntries<Cluster>(clusters, true);
+  return static_cast<int>((1000 * used) / (clusters * getClusterSize()));
+}
+
+std::size_t TT::getNumberOfEntries() const {
+  if (!maxNumberOfEntries) return 0;
+  return compact ? countEntries<CompactCluster>(numberOfClusters, false) : countEntries<Cluster>(numberOfClusters, false);
+}
 
-  Entry* ttEntryPtr = getEntryPtr(key);
-  if (ttEntryPtr->key == key) {
-    numberOfHits++;                        // entries with identical keys found
-    if (ttEntryPtr->age) ttEntryPtr->age--;// mark the entry as used
-    return ttEntryPtr;
+template<typename C>
+std::size_t TT::countEntries(const std::size_t clusters, const bool currentGenerationOnly) const {
+  const C* clusterPtr = reinterpret_cast<const C*>(_data);
+  std::size_t count   = 0;
+  uint64_t data;
+  bool empty;
+  for (std::size_t c = 0; c < clusters; ++c) {
+    for (std::size_t i = 0; i < C::SIZE; ++i) {
+      clusterPtr[c].read(i, 0, data, empty);
+      if (!empty && (!currentGenerationOnly || generationOf(data) == generation)) count++;
+    }
   }
+  return count;
+}
 
-  numberOfMisses++;// keys not found (not equal to TT misses)
-  return nullptr;
+void TT::resetStatistics() {
+  for (auto& s : stats) {
+    s.numberOfPuts       = 0;
+    s.numberOfHits       = 0;
+    s.numberOfUpdates    = 0;
+    s.numberOfMisses     = 0;
+    s.numberOfCollisions = 0;
+    s.numberOfOverwrites = 0;
+    s.numberOfProbes     = 0;
+  }
 }
 
-void TT::ageEntries() {
-  if (!maxNumberOfEntries) {
-    return;
+std::size_t TT::statsSlot() {
+  // each thread gets its own statistics slot on first use
+  static std::atomic<std::size_t> nextSlot{0};
+  thread_local const std::size_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed) % STATS_SLOTS;
+  return slot;
+}
+
+bool TT::save(const std::string& path) const {
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  FileHeader header{};
+  header.version          = FILE_VERSION;
+  header.entrySize        = getEntrySize();
+  header.clusterSize      = getClusterSize();
+  header.sizeInByte       = sizeInByte;
+  header.numberOfClusters = numberOfClusters;
+  header.generation       = generation;
+
+  // Write to a temporary file and replace the target afterwards. The TT
+  // might be mapped from the target file (see load()) and truncating a
+  // mapped file would invalidate the mapping.
+  const std::string tmpPath = path + ".tmp";
+  std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    LOG__ERROR(Logger::get().TT_LOG, "Could not open TT file {} for writing", tmpPath);
+    return false;
+  }
+  char headerBlock[FILE_HEADER_SIZE]{};
+  std::memcpy(headerBlock, &header, sizeof(FileHeader));
+  file.write(headerBlock, FILE_HEADER_SIZE);
+  file.write(reinterpret_cast<const char*>(_data), static_cast<std::streamsize>(numberOfClusters * sizeof(Cluster)));
+  file.close();
+  std::error_code error;
+  if (!file || (std::filesystem::rename(tmpPath, path, error), error)) {
+    LOG__ERROR(Logger::get().TT_LOG, "Could not write TT file {}", path);
+    std::filesystem::remove(tmpPath, error);
+    return false;
   }
-  LOG__TRACE(Logger::get().TT_LOG, "Aging TT ({} threads)...", noOfThreads);
-  auto timePoint = std::chrono::high_resolution_clock::now();
 
-  // split work onto multiple threads
-  std::vector<std::thread> threads;
-  threads.reserve(noOfThreads);
-  for (unsigned int idx = 0; idx < noOfThreads; ++idx) {
-    threads.emplace_back([&, this, idx]() {
-      auto range = maxNumberOfEntries / noOfThreads;
-      auto start = idx * range;
-      auto end   = start + range;
-      if (idx == noOfThreads - 1) end = maxNumberOfEntries;
-      for (std::size_t i = start; i < end; ++i) {
-        if (_data[i].key == 0) continue;
-        _data[i].age++;
-        if (_data[i].age > 7) _data[i].age = 7;
-      }
-    });
+  auto finish = std::chrono::high_resolution_clock::now();
+  auto time   = std::chrono::duration_cast<std::chrono::milliseconds>(finish - startTime).count();
+  LOG__INFO(Logger::get().TT_LOG, "TT saved to {} ({:L} MB) in {:L} ms", path, sizeInByte / MB, time);
+  return true;
+}
+
+bool TT::load(const std::string& path) {
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  // read and verify the header before replacing the current table
+  FileHeader header{};
+  std::ifstream file(path, std::ios::binary);
+  if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader))) {
+    LOG__ERROR(Logger::get().TT_LOG, "Could not read TT file {}", path);
+    return false;
+  }
+  file.close();
+  if (std::memcmp(header.magic, FileHeader{}.magic, sizeof(header.magic)) != 0
+      || header.version != FILE_VERSION
+      || !((header.entrySize == ENTRY_SIZE && header.clusterSize == CLUSTER_SIZE)
+           || (header.entrySize == COMPACT_ENTRY_SIZE && header.clusterSize == COMPACT_CLUSTER_SIZE))
+      || header.numberOfClusters == 0
+      || (header.numberOfClusters & (header.numberOfClusters - 1)) != 0
+      || header.sizeInByte != header.numberOfClusters * sizeof(Cluster)) {
+    LOG__ERROR(Logger::get().TT_LOG, "TT file {} has an invalid header or an incompatible format (version {})", path, header.version);
+    return false;
   }
 
-  // wait for the threads to finish
-  for (std::thread& th : threads) th.join();
+  // map into a separate block so the current table survives a failed mapping
+  LargeMemory fileMemory{};
+  auto* base = static_cast<char*>(fileMemory.mapFile(path, FILE_HEADER_SIZE + header.sizeInByte));
+  if (!base) {
+    LOG__ERROR(Logger::get().TT_LOG, "Could not map TT file {}", path);
+    return false;
+  }
+  memory.swap(fileMemory);// the old table is released with fileMemory
+
+  _data              = reinterpret_cast<Cluster*>(base + FILE_HEADER_SIZE);
+  compact            = header.entrySize == COMPACT_ENTRY_SIZE;
+  sizeInByte         = header.sizeInByte;
+  numberOfClusters   = header.numberOfClusters;
+  maxNumberOfEntries = numberOfClusters * getClusterSize();
+  hashKeyMask        = numberOfClusters - 1;
+  generation         = header.generation;
+
+  // statistics are not part of the file
+  resetStatistics();
 
   auto finish = std::chrono::high_resolution_clock::now();
-  auto time   = std::chrono::duration_cast<std::chrono::milliseconds>(finish - timePoint).count();
-  LOG__DEBUG(Logger::get().TT_LOG, "TT aged {:L} entries in {:L} ms ({} threads)", maxNumberOfEntries, time, noOfThreads);
+  auto time   = std::chrono::duration_cast<std::chrono::milliseconds>(finish - startTime).count();
+  LOG__INFO(Logger::get().TT_LOG, "TT loaded from {} ({:L} MB, generation {}) in {:L} ms", path, sizeInByte / MB, generation, time);
+  return true;
 }
 
 std::string TT::str() {
+  const uint64_t numberOfProbes = getNumberOfProbes();
+  const uint64_t numberOfHits   = getNumberOfHits();
+  const uint64_t numberOfMisses = getNumberOfMisses();
+  // the fill level is sampled - counting all entries would touch every page
+  // of the table which is too slow for a status message (e.g. after loading)
+  const int hashfull            = hashFull();
   return fmt::format(
-    "TT: size {:L} MB max entries {:L} of size {:L} Bytes entries {:L} ({:L}%) puts {:L} "
+    "TT: size {:L} MB ({}) max entries {:L} of size {:L} Bytes hashfull {:L} ({:L}%) puts {:L} "
     "updates {:L} collisions {:L} overwrites {:L} probes {:L} hits {:L} ({:L}%) misses {:L} ({:L}%)",
-    sizeInByte / MB, maxNumberOfEntries, sizeof(Entry), numberOfEntries, hashFull() / 10,
-    numberOfPuts, numberOfUpdates, numberOfCollisions, numberOfOverwrites, numberOfProbes,
+    sizeInByte / MB, memory.str(), maxNumberOfEntries, getEntrySize(), hashfull, hashfull / 10,
+    getNumberOfPuts(), getNumberOfUpdates(), getNumberOfCollisions(), getNumberOfOverwrites(), numberOfProbes,
     numberOfHits, numberOfProbes ? (numberOfHits * 100) / numberOfProbes : 0,
     numberOfMisses, numberOfProbes ? (numberOfMisses * 100) / numberOfProbes : 0);
 }
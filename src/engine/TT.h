@@ -17,8 +17,14 @@
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <iosfwd>
+#include <optional>
+#include <string>
 
+#include "common/LargeMemory.h"
 #include "types/types.h"
 #include "gtest/gtest_prod.h"
 
@@ -41,15 +47,32 @@
 #endif
 
 /**
- * TT implementation using heap memory and simple hash for entries.
+ * TT implementation using heap memory and clusters of entries.
  * The number of entries are always a power of two fitting into the given size.
- * It is not yet thread safe as it has no synchronization.
+ * Each key maps to a cluster of 4 entries which fills exactly one cache line
+ * so a probe needs only one memory access (and one prefetch). Within a
+ * cluster the entry with the lowest depth minus age is replaced first.
  *
- * Tests have shown that an implementation with a struct and bitfields is
- * more efficient than using only one 64-bit data field with manual bit shifting
- * and masking (~9% slower)
- * Also using buckets has not shown significant strength improvements and is
- * much slower (~20% slower).
+ * Entries store the search generation they were last written or used in.
+ * Starting a new search only increments the TT's generation counter and
+ * the age of an entry is computed from the difference of both when probing
+ * or replacing. This makes starting a search O(1) independent of the TT size.
+ *
+ * The TT is lock-free and can be shared by several search threads.
+ * Each entry is stored as two 64-bit words: the packed data and the key
+ * xor'ed with the packed data. When reading an entry the key is restored
+ * from both words and only if it matches the probed key the entry is
+ * accepted. Entries torn by concurrent writes of other threads will not
+ * match and are simply treated as misses (Hyatt/Mann lockless hashing).
+ * Probes therefore return a copy of the entry and never a pointer into
+ * the table.
+ *
+ * Optionally the TT uses a compact entry format of 10 bytes which fits
+ * 6 instead of 4 entries into a cluster (see CompactCluster). As the low
+ * bits of the key are implied by the cluster index only the upper 16 bits
+ * of the key are used to verify an entry. This raises the capacity per MB
+ * by 50% at the cost of more false positive matches which is why moves
+ * from the TT must always be verified before they are used.
  */
 class TT {
 public:
@@ -63,9 +86,10 @@ public:
   //  Value eval    = VALUE_NONE;// 16 bit signed
   //  Value value   = VALUE_NONE;// 16 bit signed
   //  Depth depth : 7;           // 0-127
-  //  uint8_t age : 3;           // 0-7
+  //  uint8_t age : 3;           // 0-7 (generations since last used)
   //  ValueType type : 2;        // 4 values
   //  bool mateThreat : 1;       // 1-bit bool
+  // This is a copy of an entry as returned by probe() and getMatch().
   struct Entry {
     // sorted by size to achieve smallest struct size
     // using bitfield for smallest size
@@ -74,14 +98,108 @@ public:
     Value eval    = VALUE_NONE;// 16 bit signed
     Value value   = VALUE_NONE;// 16 bit signed
     int8_t depth : 7;          // 0-127
-    uint8_t age : 3;           // 0-7
+    uint8_t age : 3;           // 0-7 (generations since last used)
     ValueType type : 2;        // 4 values
     friend std::ostream& operator<<(std::ostream& os, const Entry& entry);
   };
 
-  // struct Entry has 16 Byte
-  static constexpr uint64_t ENTRY_SIZE = sizeof(Entry);
+  // How an entry is actually stored in the table.
+  // data       : move (16), eval (16), value (16), depth (7), generation (5), type (2)
+  // keyXorData : key ^ data
+  struct Slot {
+    std::atomic<uint64_t> keyXorData{0};
+    std::atomic<uint64_t> data{0};
+  };
+
+  // struct Slot has 16 Byte
+  static constexpr uint64_t ENTRY_SIZE = sizeof(Slot);
   static_assert(CacheLineSize % ENTRY_SIZE == 0, "Cluster size incorrect");
+  static_assert(std::atomic<uint64_t>::is_always_lock_free, "TT requires lock free 64-bit atomics");
+
+  // entries of a cluster share one cache line
+  static constexpr std::size_t CLUSTER_SIZE = CacheLineSize / ENTRY_SIZE;
+  struct alignas(CacheLineSize) Cluster {
+    Slot slots[CLUSTER_SIZE];
+
+    static constexpr std::size_t SIZE = CLUSTER_SIZE;
+
+    /* loads the data of slot i and returns true if it belongs to key */
+    inline bool read(const std::size_t i, const Key key, uint64_t& data, bool& empty) const {
+      data               = slots[i].data.load(std::memory_order_relaxed);
+      const Key entryKey = slots[i].keyXorData.load(std::memory_order_relaxed) ^ data;
+      empty              = entryKey == 0;
+      return entryKey == key;
+    }
+
+    /* stores the given entry data under the given key in slot i */
+    inline void write(const std::size_t i, const Key key, const uint64_t data) {
+      slots[i].data.store(data, std::memory_order_relaxed);
+      slots[i].keyXorData.store(key ^ data, std::memory_order_relaxed);
+    }
+  };
+  static_assert(sizeof(Cluster) == CacheLineSize, "Cluster size incorrect");
+
+  // Compact entry format with 10 bytes per entry.
+  // data  : as Slot::data plus a used flag (bit 62) so that an empty entry is 0
+  // check : upper 16 bits of the key xor'ed with all 16-bit parts of data
+  // The data words and the check words are kept in separate arrays to
+  // fit 6 entries into one cache line with naturally aligned atomics.
+  // Torn entries fail the check and are treated as misses as above.
+  static constexpr uint64_t COMPACT_ENTRY_SIZE      = sizeof(uint64_t) + sizeof(uint16_t);
+  static constexpr std::size_t COMPACT_CLUSTER_SIZE = CacheLineSize / COMPACT_ENTRY_SIZE;
+  static constexpr uint64_t COMPACT_USED            = 1ULL << 62;
+  struct alignas(CacheLineSize) CompactCluster {
+    std::atomic<uint64_t> data[COMPACT_CLUSTER_SIZE]{};
+    std::atomic<uint16_t> check[COMPACT_CLUSTER_SIZE]{};
+
+    static constexpr std::size_t SIZE = COMPACT_CLUSTER_SIZE;
+
+    static inline uint16_t checkOf(const Key key, const uint64_t data) {
+      return static_cast<uint16_t>((key >> 48) ^ data ^ (data >> 16) ^ (data >> 32) ^ (data >> 48));
+    }
+
+    /* loads the data of slot i and returns true if it belongs to key */
+    inline bool read(const std::size_t i, const Key key, uint64_t& entryData, bool& empty) const {
+      entryData = data[i].load(std::memory_order_relaxed);
+      empty     = entryData == 0;
+      return !empty && check[i].load(std::memory_order_relaxed) == checkOf(key, entryData);
+    }
+
+    /* stores the given entry data under the given key in slot i */
+    inline void write(const std::size_t i, const Key key, const uint64_t entryData) {
+      data[i].store(entryData | COMPACT_USED, std::memory_order_relaxed);
+      check[i].store(checkOf(key, entryData | COMPACT_USED), std::memory_order_relaxed);
+    }
+  };
+  static_assert(sizeof(CompactCluster) == CacheLineSize, "Compact cluster size incorrect");
+  static_assert(std::atomic<uint16_t>::is_always_lock_free, "TT requires lock free 16-bit atomics");
+
+  // weight of the age of an entry when choosing the entry to replace
+  // in a cluster (depth - AGE_WEIGHT * age)
+  static constexpr int AGE_WEIGHT = 8;
+
+  // number of clusters at the start of the table sampled by hashFull()
+  static constexpr std::size_t HASHFULL_SAMPLE_CLUSTERS = 256;
+
+  // search generations are stored with 5 bits and wrap around
+  static constexpr uint8_t GENERATION_MASK = 0x1F;
+  static constexpr uint8_t MAX_AGE         = 7;
+
+  // Header of a TT file written by save(). The clusters follow the
+  // header at FILE_HEADER_SIZE so they are page aligned when mapped.
+  // FILE_VERSION must be increased when the entry format changes.
+  struct FileHeader {
+    char magic[8]             = {'F', 'R', 'A', 'N', 'K', 'Y', 'T', 'T'};
+    uint32_t version          = 0;
+    uint32_t entrySize        = 0;
+    uint64_t clusterSize      = 0;
+    uint64_t sizeInByte       = 0;
+    uint64_t numberOfClusters = 0;
+    uint8_t generation        = 0;
+  };
+  static constexpr uint32_t FILE_VERSION        = 1;
+  static constexpr std::size_t FILE_HEADER_SIZE = 4096;
+  static_assert(sizeof(FileHeader) <= FILE_HEADER_SIZE, "TT file header too large");
 
 private:
   // threads for clearing hash
@@ -90,20 +208,39 @@ private:
   // size and fill info
   uint64_t sizeInByte            = 0;
   std::size_t maxNumberOfEntries = 0;
+  std::size_t numberOfClusters   = 0;
   std::size_t hashKeyMask        = 0;
-  std::size_t numberOfEntries    = 0;
+
+  // current search generation
+  uint8_t generation = 0;
+
+  // entries are stored in the compact 10 byte format
+  bool compact = false;
 
   // statistics
-  mutable uint64_t numberOfPuts       = 0;
-  mutable uint64_t numberOfCollisions = 0;
-  mutable uint64_t numberOfOverwrites = 0;
-  mutable uint64_t numberOfUpdates    = 0;
-  mutable uint64_t numberOfProbes     = 0;
-  mutable uint64_t numberOfHits       = 0;// entries with identical key found
-  mutable uint64_t numberOfMisses     = 0;// no entry with key found
+  // Counted per thread in cache line aligned slots to avoid contention
+  // between search threads. Counters are relaxed atomics which are
+  // incremented without a locked read-modify-write. If more threads than
+  // slots are used a few counts might be lost which is acceptable for
+  // statistics.
+  struct alignas(CacheLineSize) Stats {
+    std::atomic<uint64_t> numberOfPuts{0};
+    std::atomic<uint64_t> numberOfCollisions{0};
+    std::atomic<uint64_t> numberOfOverwrites{0};
+    std::atomic<uint64_t> numberOfUpdates{0};
+    std::atomic<uint64_t> numberOfProbes{0};
+    std::atomic<uint64_t> numberOfHits{0};  // entries with identical key found
+    std::atomic<uint64_t> numberOfMisses{0};// no entry with key found
+  };
+  static constexpr std::size_t STATS_SLOTS = 64;
+  mutable std::array<Stats, STATS_SLOTS> stats{};
+
+  // memory block (large pages if available) holding the clusters
+  LargeMemory memory;
 
   // this array hold the actual entries for the transposition table
-  Entry* _data{};
+  // (CompactCluster when using compact entries - both have the same size)
+  Cluster* _data{};
 
 public:
   // TT default size is 2 MB
@@ -112,12 +249,11 @@ public:
   /**
    * @param newSizeInMByte Size of TT in bytes which will be reduced to the next lowest power of 2 size
    *                        Limited to 32.000MB
+   * @param compactEntries use the compact 10 byte entry format
    */
-  explicit TT(uint64_t newSizeInMByte);
+  explicit TT(uint64_t newSizeInMByte, bool compactEntries = false);
 
-  ~TT() {
-    delete[] _data;
-  }
+  ~TT() = default;
 
   // disallow copies
   TT(TT const& tt) = delete;         // copy
@@ -127,6 +263,8 @@ public:
 
   /**
    * Changes the size of the transposition table and clears all entries.
+   * Memory is allocated with large pages and NUMA interleaving as
+   * configured in SearchConfig.
    * @param newSizeInMByte in Byte which will be reduced to the next
    * lowest power of 2 size. Limited to 32.000 MB.
    */
@@ -135,6 +273,26 @@ public:
   /** Clears the transposition table be resetting all entries to 0. */
   void clear();
 
+  /**
+   * Writes the transposition table with a header (size, entry format
+   * version and generation) to the given file. Must not be called while
+   * other threads write to the TT.
+   * @return true if the file was written successfully
+   */
+  bool save(const std::string& path) const;
+
+  /**
+   * Replaces the transposition table with the content of a file written
+   * by save(). The file is mapped copy on write so loading is independent
+   * of the TT size and the file is never changed by the search. The TT
+   * takes the size and entry format of the file. If the file is missing,
+   * has a different format or can't be mapped (e.g. is shorter than its
+   * header states) the TT is left unchanged. The file must not be truncated by
+   * other processes while it is mapped (save() replaces files safely).
+   * @return true if the file was loaded successfully
+   */
+  bool load(const std::string& path);
+
   /**
     * Stores the node value and the depth it has been calculated at.
     * Also stores the best move for the node.
@@ -150,30 +308,37 @@ public:
   void put(Key key, Depth depth, Move move, Value value, ValueType type, Value eval);
 
   /**
-   * This retrieves a ptr to the entry of this node from cache.
+   * This retrieves a copy of the entry of this node from cache.
    *
    * @param key Position key (usually Zobrist key)
-   * @return Pointer to entry for key or nullptr if not found
+   * @return Copy of the entry for key or an empty optional if not found
    */
-  inline const TT::Entry* getMatch(const Key key) const {
-    const Entry* const entryPtr = getEntryPtr(key);
-    return entryPtr->key == key ? entryPtr : nullptr;
+  inline std::optional<TT::Entry> getMatch(const Key key) const {
+    return compact ? getMatch(*getCompactClusterPtr(key), key) : getMatch(*getClusterPtr(key), key);
   }
 
   /**
-   * Looks up and returns a pointer to an TT Entry. Decreases age of the entry
-   * if an entry was found
+   * Looks up and returns a copy of a TT Entry. Marks the entry as used
+   * in the current generation if an entry was found
    */
-  const TT::Entry* probe(const Key& key);
+  std::optional<TT::Entry> probe(const Key& key);
 
-  /** Age all entries by 1 */
-  void ageEntries();
+  /**
+   * Starts a new search generation. All entries not used in the new
+   * generation age by 1. This does not touch any entries.
+   */
+  inline void newGeneration() {
+    generation = (generation + 1) & GENERATION_MASK;
+  }
 
-  /** Returns how full the transposition table is in permill as per UCI */
-  inline int hashFull() const {
-    if (!maxNumberOfEntries) return 0;
-    return static_cast<int>((1000 * numberOfEntries) / maxNumberOfEntries);
-  };
+  /**
+   * Returns how full the transposition table is in permill as per UCI.
+   * This is an estimate from the entries of the current search generation
+   * in the first HASHFULL_SAMPLE_CLUSTERS clusters. As keys are evenly
+   * distributed over the table this is representative for the whole table
+   * and cheap enough to be called during a search from any thread.
+   */
+  int hashFull() const;
 
     // using prefetch improves probe lookup speed significantly
 #ifdef TT_ENABLE_PREFETCH
@@ -195,51 +360,150 @@ private:
     return key & hashKeyMask;
   }
 
-  /* This retrieves a direct pointer to the entry of this node from cache */
-  inline TT::Entry* getEntryPtr(const Key key) const {
+  /* This retrieves a direct pointer to the cluster of this node from cache */
+  inline TT::Cluster* getClusterPtr(const Key key) const {
     return &_data[getHash(key)];
   }
 
+  /* same as getClusterPtr() for the compact entry format */
+  inline TT::CompactCluster* getCompactClusterPtr(const Key key) const {
+    return &reinterpret_cast<CompactCluster*>(_data)[getHash(key)];
+  }
+
+  /* put(), probe() and getMatch() for both cluster formats */
+  template<typename C>
+  void put(C& cluster, Key key, Depth depth, Move move, Value value, ValueType type, Value eval);
+
+  template<typename C>
+  std::optional<TT::Entry> probe(C& cluster, Key key);
+
+  /* counts the used entries in the first clusters - optionally only those of the current generation */
+  template<typename C>
+  std::size_t countEntries(std::size_t clusters, bool currentGenerationOnly) const;
+
+  template<typename C>
+  inline std::optional<TT::Entry> getMatch(const C& cluster, const Key key) const {
+    uint64_t data;
+    bool empty;
+    for (std::size_t i = 0; i < C::SIZE; ++i) {
+      if (cluster.read(i, key, data, empty)) return decode(key, data);
+    }
+    return std::nullopt;
+  }
+
+  /* packs all entry fields except the key into one 64-bit word */
+  static inline uint64_t encode(Move move, Value eval, Value value, Depth depth, uint8_t gen, ValueType type) {
+    return static_cast<uint64_t>(static_cast<uint16_t>(move))
+           | static_cast<uint64_t>(static_cast<uint16_t>(eval)) << 16
+           | static_cast<uint64_t>(static_cast<uint16_t>(value)) << 32
+           | static_cast<uint64_t>(depth & 0x7F) << 48
+           | static_cast<uint64_t>(gen & GENERATION_MASK) << 55
+           | static_cast<uint64_t>(type & 0x3) << 60;
+  }
+
+  /* generation an entry has been stored with */
+  static inline uint8_t generationOf(const uint64_t data) {
+    return static_cast<uint8_t>((data >> 55) & GENERATION_MASK);
+  }
+
+  /* replaces the generation of an entry with the current generation */
+  inline uint64_t refresh(const uint64_t data) const {
+    return (data & ~(static_cast<uint64_t>(GENERATION_MASK) << 55)) | static_cast<uint64_t>(generation) << 55;
+  }
+
+  /* unpacks a 64-bit data word into an entry copy */
+  inline Entry decode(const Key key, const uint64_t data) const {
+    Entry entry{};
+    entry.key   = key;
+    entry.move  = static_cast<uint16_t>(data);
+    entry.eval  = static_cast<Value>(static_cast<int16_t>(data >> 16));
+    entry.value = static_cast<Value>(static_cast<int16_t>(data >> 32));
+    entry.depth = static_cast<int8_t>((data >> 48) & 0x7F);
+    entry.age   = std::min<uint8_t>(MAX_AGE, (generation - generationOf(data)) & GENERATION_MASK);
+    entry.type  = static_cast<ValueType>((data >> 60) & 0x3);
+    return entry;
+  }
+
+  /* statistics slot of the current thread */
+  inline Stats& threadStats() const {
+    return stats[statsSlot()];
+  }
+  static std::size_t statsSlot();
+
+  /* resets all statistic counters to 0 */
+  void resetStatistics();
+
+  /* increments a statistic counter without a locked read-modify-write */
+  static inline void inc(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  /* sums up a statistic counter over all thread slots */
+  uint64_t sum(std::atomic<uint64_t> Stats::*counter) const {
+    uint64_t total = 0;
+    for (const auto& s : stats) total += (s.*counter).load(std::memory_order_relaxed);
+    return total;
+  }
+
   /** GETTER and SETTER */
 public:
   uint64_t getSizeInByte() const {
     return sizeInByte;
   }
 
+  uint8_t getGeneration() const {
+    return generation;
+  }
+
+  std::size_t getPageSize() const {
+    return memory.getPageSize();
+  }
+
+  bool isCompact() const {
+    return compact;
+  }
+
+  uint64_t getEntrySize() const {
+    return compact ? COMPACT_ENTRY_SIZE : ENTRY_SIZE;
+  }
+
+  std::size_t getClusterSize() const {
+    return compact ? COMPACT_CLUSTER_SIZE : CLUSTER_SIZE;
+  }
+
   std::size_t getMaxNumberOfEntries() const {
     return maxNumberOfEntries;
   }
 
-  std::size_t getNumberOfEntries() const {
-    return numberOfEntries;
-  }
+  /* counts all used entries - this scans the whole table */
+  std::size_t getNumberOfEntries() const;
 
   uint64_t getNumberOfPuts() const {
-    return numberOfPuts;
+    return sum(&Stats::numberOfPuts);
   }
 
   uint64_t getNumberOfCollisions() const {
-    return numberOfCollisions;
+    return sum(&Stats::numberOfCollisions);
   }
 
   uint64_t getNumberOfOverwrites() const {
-    return numberOfOverwrites;
+    return sum(&Stats::numberOfOverwrites);
   }
 
   uint64_t getNumberOfUpdates() const {
-    return numberOfUpdates;
+    return sum(&Stats::numberOfUpdates);
   }
 
   uint64_t getNumberOfProbes() const {
-    return numberOfProbes;
+    return sum(&Stats::numberOfProbes);
   }
 
   uint64_t getNumberOfHits() const {
-    return numberOfHits;
+    return sum(&Stats::numberOfHits);
   }
 
   uint64_t getNumberOfMisses() const {
-    return numberOfMisses;
+    return sum(&Stats::numberOfMisses);
   }
 
   unsigned int getThreads() const {
@@ -265,9 +529,10 @@ public:
   }
 
   FRIEND_TEST(TT_Test, put);
-  FRIEND_TEST(TT_Test, put);
+  FRIEND_TEST(TT_Test, cluster);
   FRIEND_TEST(TT_Test, get);
   FRIEND_TEST(TT_Test, probe);
+  FRIEND_TEST(TT_Test, compact);
 };
 
 #endif//FRANKYCPP_TT_H
@@ -29,7 +29,9 @@
 #include "version.h"
 
 #include <exception>
+#include <iterator>
 #include <memory>
+#include <ostream>
 #include <thread>
 
 UciHandler::UciHandler() {
@@ -47,6 +49,35 @@ UciHandler::UciHandler(std::istream* pIstream, std::ostream* pOstream) : UciHand
   pOutputStream = pOstream;
 }
 
+template<typename... Args>
+void UciHandler::formatOutput(const char* format, Args&&... args) const {
+  outputBuffer.clear();
+  fmt::format_to(std::back_inserter(outputBuffer), format, std::forward<Args>(args)...);
+}
+
+void UciHandler::appendMoves(const MoveList& moves) const {
+  for (const Move move : moves) {
+    // the uci notation of a move fits into the small string buffer
+    const std::string uciMove = str(move);
+    outputBuffer.push_back(' ');
+    outputBuffer.append(uciMove.data(), uciMove.data() + uciMove.size());
+  }
+}
+
+void UciHandler::writeOutput(bool flush) const {
+  LOG__INFO(Logger::get().UCI_LOG, ">> {}", fmt::string_view(outputBuffer.data(), outputBuffer.size()));
+  outputBuffer.push_back('\n');
+  pOutputStream->write(outputBuffer.data(), static_cast<std::streamsize>(outputBuffer.size()));
+  if (flush) pOutputStream->flush();
+}
+
+template<typename... Args>
+void UciHandler::sendFormatted(bool flush, const char* format, Args&&... args) const {
+  std::lock_guard<std::mutex> lock(outputMutex);
+  formatOutput(format, std::forward<Args>(args)...);
+  writeOutput(flush);
+}
+
 void UciHandler::loop() {
   loop(pInputStream);
 }
@@ -79,7 +110,7 @@ bool UciHandler::handleCommand(const std::string& cmd) {
   inStream >> std::skipws >> token;
 
   // @formatter:off
-  if (token == "quit") { return true; }
+  if (token == "quit") { quitCommand(); return true; }
   else if (token == "uci") { uciCommand(); }
   else if (token == "isready") { isReadyCommand(); }
   else if (token == "setoption") { setOptionCommand(inStream); }
@@ -91,6 +122,8 @@ bool UciHandler::handleCommand(const std::string& cmd) {
   else if (token == "register") { registerCommand(); }
   else if (token == "debug") { debugCommand(); }
   else if (token == "perft") { perftCommand(inStream); }
+  else if (token == "savehash") { saveHashCommand(inStream); }
+  else if (token == "loadhash") { loadHashCommand(inStream); }
   else if (token == "noop") { /* noop */}
   else uciError(fmt::format("Unknown UCI command: {}", token));
   // @formatter:on
@@ -100,10 +133,10 @@ bool UciHandler::handleCommand(const std::string& cmd) {
 }
 
 void UciHandler::uciCommand() const {
-  send("id name FrankyCPP v" + std::to_string(FrankyCPP_VERSION_MAJOR) + "." + std::to_string(FrankyCPP_VERSION_MINOR));
-  send("id author Frank Kopp, Germany");
-  send(UciOptions::getInstance()->str());
-  send("uciok");
+  sendFormatted(false, "id name FrankyCPP v{}.{}", FrankyCPP_VERSION_MAJOR, FrankyCPP_VERSION_MINOR);
+  sendFormatted(false, "id author Frank Kopp, Germany");
+  sendFormatted(false, "{}", UciOptions::getInstance()->str());
+  sendFormatted(true, "uciok");
 }
 
 void UciHandler::isReadyCommand() const {
@@ -138,6 +171,12 @@ void UciHandler::setOptionCommand(std::istringstream& inStream) const {
 void UciHandler::uciNewGameCommand() const {
   LOG__INFO(Logger::get().UCIHAND_LOG, "New Game");
   if (pSearch->isSearching()) pSearch->stopSearch();
+  // GUIs send ucinewgame right after startup - keep a persistent hash
+  // which has just been loaded from file and not yet searched with
+  if (pSearch->keepTTForNewGame()) {
+    LOG__INFO(Logger::get().UCIHAND_LOG, "Keeping persistent hash loaded from file");
+    return;
+  }
   pSearch->clearTT();
 }
 
@@ -397,7 +436,7 @@ void UciHandler::perftCommand(std::istringstream& inStream) {
     return;
   }
   int endDepth = startDepth;
-  if (inStream >> token) {
+  if (inStream >> token && token != "details") {
     try {
       endDepth = stoi(token);
     } catch (...) { /* Ignore */
@@ -405,7 +444,11 @@ void UciHandler::perftCommand(std::istringstream& inStream) {
     if (endDepth <= 0 || endDepth > MAX_DEPTH) {
       uciError(fmt::format("perft end depth not between 1 and {}. Was '{}'", MAX_DEPTH, token));
     }
+    inStream >> token;
   }
+  // only count nodes unless details (captures, checks, etc.) are requested
+  pPerft->setBulkCounting(token != "details");
+  pPerft->setThreads(SearchConfig::THREADS);
   std::thread perftThread([&](int s, int e) {
     pPerft->perft(s, e, true);
     sendString("Perft finished.");
@@ -414,6 +457,27 @@ void UciHandler::perftCommand(std::istringstream& inStream) {
   perftThread.detach();
 }
 
+void UciHandler::saveHashCommand(std::istringstream& inStream) const {
+  std::string path;
+  if (!(inStream >> path)) path = SearchConfig::TT_FILE;
+  LOG__INFO(Logger::get().UCIHAND_LOG, "Saving hash to {}", path);
+  pSearch->saveTT(path);
+}
+
+void UciHandler::loadHashCommand(std::istringstream& inStream) const {
+  std::string path;
+  if (!(inStream >> path)) path = SearchConfig::TT_FILE;
+  LOG__INFO(Logger::get().UCIHAND_LOG, "Loading hash from {}", path);
+  pSearch->loadTT(path);
+}
+
+void UciHandler::quitCommand() const {
+  if (SearchConfig::TT_PERSISTENT) {
+    if (pSearch->isSearching()) pSearch->stopSearch();
+    pSearch->saveTT(SearchConfig::TT_FILE);
+  }
+}
+
 void UciHandler::registerCommand() {
   uciError("UCI Protocol Command: register not implemented!");
 }
@@ -423,48 +487,68 @@ void UciHandler::debugCommand() {
 }
 
 void UciHandler::send(const std::string& toSend) const {
-  LOG__INFO(Logger::get().UCI_LOG, ">> {}", toSend);
-  *pOutputStream << toSend << std::endl;
+  sendFormatted(true, "{}", toSend);
+}
+
+void UciHandler::flush() const {
+  std::lock_guard<std::mutex> lock(outputMutex);
+  pOutputStream->flush();
 }
 
 void UciHandler::sendString(const std::string& anyString) const {
-  send(fmt::format("info string {}", anyString));
+  sendFormatted(true, "info string {}", anyString);
 }
 
 void UciHandler::sendReadyOk() const {
-  send("readyok");
+  sendFormatted(true, "readyok");
 }
 
 void UciHandler::sendResult(Move bestMove, Move ponderMove) const {
-  send(fmt::format("bestmove {}{}", str(bestMove), (ponderMove ? " ponder " + str(ponderMove) : "")));
+  if (ponderMove) {
+    sendFormatted(true, "bestmove {} ponder {}", str(bestMove), str(ponderMove));
+  }
+  else {
+    sendFormatted(true, "bestmove {}", str(bestMove));
+  }
 }
 
+// part of the info batch of sendSearchUpdate - flushed by the caller
 void UciHandler::sendCurrentLine(const MoveList& moveList) const {
-  send(fmt::format("currline {}", str(moveList)));
+  std::lock_guard<std::mutex> lock(outputMutex);
+  formatOutput("info currline");
+  appendMoves(moveList);
+  writeOutput(false);
 }
 
 void UciHandler::sendIterationEndInfo(int depth, int seldepth, Value value, uint64_t nodes,
                                       uint64_t nps, milliseconds time, const MoveList& pv) const {
-  send(fmt::format("info depth {} seldepth {} multipv 1 score {} nodes {} nps {} time {} pv {}",
-                   depth, seldepth, str(Value(value)), nodes, nps, time.count(), str(pv)));
+  std::lock_guard<std::mutex> lock(outputMutex);
+  formatOutput("info depth {} seldepth {} multipv 1 score {} nodes {} nps {} time {} pv",
+               depth, seldepth, str(Value(value)), nodes, nps, time.count());
+  appendMoves(pv);
+  writeOutput(true);
 }
 
 void UciHandler::sendAspirationResearchInfo(int depth, int seldepth, Value value,
                                             const std::string& boundString, uint64_t nodes, uint64_t nps,
                                             milliseconds time, const MoveList& pv) const {
-  send(fmt::format("info depth {} seldepth {} multipv 1 score {} {} nodes {} nps {} time {} pv {}",
-                   depth, seldepth, str(Value(value)), boundString, nodes, nps, time.count(), str(pv)));
+  std::lock_guard<std::mutex> lock(outputMutex);
+  formatOutput("info depth {} seldepth {} multipv 1 score {} {} nodes {} nps {} time {} pv",
+               depth, seldepth, str(Value(value)), boundString, nodes, nps, time.count());
+  appendMoves(pv);
+  writeOutput(true);
 }
 
+// part of the info batch of sendSearchUpdate - flushed by the caller
 void UciHandler::sendCurrentRootMove(Move currmove, std::size_t movenumber) const {
-  send(fmt::format("info currmove {} currmovenumber {}", str(currmove),
-                   movenumber));
+  sendFormatted(false, "info currmove {} currmovenumber {}", str(currmove), movenumber);
 }
 
+// starts an info batch which is flushed by the caller when it is complete
 void UciHandler::sendSearchUpdate(int depth, int seldepth, uint64_t nodes, uint64_t nps,
                                   milliseconds time, int hashfull) const {
-  send(fmt::format("info depth {} seldepth {} nodes {} nps {} time {} hashfull {}",
-                   depth, seldepth, nodes, nps, time.count(), hashfull));
+  sendFormatted(false, "info depth {} seldepth {} nodes {} nps {} time {} hashfull {}",
+                depth, seldepth, nodes, nps, time.count(), hashfull);
 }
 
 void UciHandler::uciError(std::string const& msg) const {
@@ -24,11 +24,13 @@
 #include "UciOptions.h"
 
 #include "gtest/gtest_prod.h"
+#include <fmt/format.h>
 
 #include <cstddef>
 #include <cstdint>
 #include <iosfwd>
 #include <memory>
+#include <mutex>
 
 // forward declaration
 class Position;
@@ -52,6 +54,13 @@ private:
   std::istream* pInputStream;
   std::ostream* pOutputStream;
 
+  // messages are formatted into a reused buffer and written to the output
+  // stream without flushing it - the stream is only flushed at the end of
+  // protocol relevant messages or info batches. The search thread and the
+  // uci thread both send messages so buffer and stream are guarded by a mutex.
+  mutable std::mutex outputMutex;
+  mutable fmt::memory_buffer outputBuffer;
+
 public:
   UciHandler();
 
@@ -66,7 +75,9 @@ public:
   void loop(std::istream* pIstream);
 
   // send information to the UCI user interface through pipe streams
+  // send and all send methods which end an info batch flush the output stream
   void send(const std::string& toSend) const;
+  void flush() const;
   void sendIterationEndInfo(int depth, int seldepth, Value value, uint64_t nodes, uint64_t nps, milliseconds time, const MoveList& pv) const;
   void sendAspirationResearchInfo(int depth, int seldepth, Value value, const std::string& boundString, uint64_t nodes, uint64_t nps, milliseconds time, const MoveList& pv) const;
   void sendCurrentRootMove(Move currmove, std::size_t movenumber) const;
@@ -102,11 +113,27 @@ private:
   void stopCommand() const;
   void ponderHitCommand() const;
   void perftCommand(std::istringstream& inStream);
+  void saveHashCommand(std::istringstream& inStream) const;
+  void loadHashCommand(std::istringstream& inStream) const;
+  void quitCommand() const;
   void registerCommand();
   void debugCommand();
 
   void uciError(const std::string& msg) const;
   FRIEND_TEST(UCITest, goError);
+
+  // formats the message into the output buffer and writes it as one line to
+  // the output stream which is only flushed if flush is true
+  template<typename... Args>
+  void sendFormatted(bool flush, const char* format, Args&&... args) const;
+
+  // building blocks of a message - the caller must hold the outputMutex
+  // appendMoves writes the moves directly into the output buffer as
+  // str(MoveList) would allocate a string for longer lines (e.g. the pv)
+  template<typename... Args>
+  void formatOutput(const char* format, Args&&... args) const;
+  void appendMoves(const MoveList& moves) const;
+  void writeOutput(bool flush) const;
 };
 
 
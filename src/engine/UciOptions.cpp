@@ -17,6 +17,8 @@
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+#include <filesystem>
+
 #include "UciOptions.h"
 #include "EvalConfig.h"
 #include "Search.h"
@@ -32,6 +34,14 @@ void UciOptions::initOptions() {
   optionVector.emplace_back("Ponder", SearchConfig::USE_PONDER,
                             [&](UciHandler*) { SearchConfig::USE_PONDER = getOption("Ponder")->currentValue == "true"; });
 
+  optionVector.emplace_back("UCI_ShowCurrLine", SearchConfig::UCI_SHOW_CURR_LINE,
+                            [&](UciHandler*) { SearchConfig::UCI_SHOW_CURR_LINE = getOption("UCI_ShowCurrLine")->currentValue == "true"; });
+
+  optionVector.emplace_back("Threads", SearchConfig::THREADS, 1, 256,
+                            [&](UciHandler*) { SearchConfig::THREADS = getInt(getOption("Threads")->currentValue); });
+
+  // search and evaluation features are constants in a tournament build
+#ifndef TOURNAMENT_BUILD
   optionVector.emplace_back("Use AlphaBeta", SearchConfig::USE_ALPHABETA,
                             [&](UciHandler*) { SearchConfig::USE_ALPHABETA = getOption("Use AlphaBeta")->currentValue == "true"; });
 
@@ -43,10 +53,21 @@ void UciOptions::initOptions() {
 
   optionVector.emplace_back("Use Hash", SearchConfig::USE_TT,
                             [&](UciHandler*) { SearchConfig::USE_TT = getOption("Use Hash")->currentValue == "true"; });
+#endif
 
   optionVector.emplace_back("Hash", SearchConfig::TT_SIZE_MB, 0, 4096,
                             [&](UciHandler* uciHandler) { SearchConfig::TT_SIZE_MB = getInt(getOption("Hash")->currentValue); uciHandler->getSearchPtr()->resizeTT(); });
 
+  optionVector.emplace_back("Hash Compact Entries", SearchConfig::TT_COMPACT,
+                            [&](UciHandler* uciHandler) { SearchConfig::TT_COMPACT = getOption("Hash Compact Entries")->currentValue == "true"; uciHandler->getSearchPtr()->resizeTT(); });
+
+  optionVector.emplace_back("Large Pages", SearchConfig::USE_LARGE_PAGES,
+                            [&](UciHandler* uciHandler) { SearchConfig::USE_LARGE_PAGES = getOption("Large Pages")->currentValue == "true"; uciHandler->getSearchPtr()->resizeTT(); });
+
+  optionVector.emplace_back("NUMA Interleave", SearchConfig::USE_NUMA_INTERLEAVE,
+                            [&](UciHandler* uciHandler) { SearchConfig::USE_NUMA_INTERLEAVE = getOption("NUMA Interleave")->currentValue == "true"; uciHandler->getSearchPtr()->resizeTT(); });
+
+#ifndef TOURNAMENT_BUILD
   optionVector.emplace_back("Use Hash Value", SearchConfig::USE_TT_VALUE,
                             [&](UciHandler*) { SearchConfig::USE_TT_VALUE = getOption("Use Hash Value")->currentValue == "true"; });
 
@@ -55,10 +76,27 @@ void UciOptions::initOptions() {
 
   optionVector.emplace_back("Use Hash Quiescence", SearchConfig::USE_QS_TT,
                             [&](UciHandler*) { SearchConfig::USE_QS_TT = getOption("Use Hash Quiescence")->currentValue == "true"; });
+#endif
 
   optionVector.emplace_back("Clear Hash",
                             [&](UciHandler* uciHandler) { uciHandler->getSearchPtr()->clearTT(); });
 
+  optionVector.emplace_back("Hash File", SearchConfig::TT_FILE.c_str(),
+                            [&](UciHandler*) { SearchConfig::TT_FILE = getOption("Hash File")->currentValue; });
+
+  optionVector.emplace_back("Save Hash",
+                            [&](UciHandler* uciHandler) { uciHandler->getSearchPtr()->saveTT(SearchConfig::TT_FILE); });
+
+  optionVector.emplace_back("Load Hash",
+                            [&](UciHandler* uciHandler) { uciHandler->getSearchPtr()->loadTT(SearchConfig::TT_FILE); });
+
+  optionVector.emplace_back("Persistent Hash", SearchConfig::TT_PERSISTENT,
+                            [&](UciHandler* uciHandler) {
+                              SearchConfig::TT_PERSISTENT = getOption("Persistent Hash")->currentValue == "true";
+                              if (SearchConfig::TT_PERSISTENT && std::filesystem::exists(SearchConfig::TT_FILE)) uciHandler->getSearchPtr()->loadTT(SearchConfig::TT_FILE);
+                            });
+
+#ifndef TOURNAMENT_BUILD
   optionVector.emplace_back("Use Killer Moves", SearchConfig::USE_KILLER_MOVES,
                             [&](UciHandler*) { SearchConfig::USE_KILLER_MOVES = getOption("Use Killer Moves")->currentValue == "true"; });
 
@@ -68,6 +106,9 @@ void UciOptions::initOptions() {
   optionVector.emplace_back("Use History Counter", SearchConfig::USE_HISTORY_COUNTER,
                             [&](UciHandler*) { SearchConfig::USE_HISTORY_COUNTER = getOption("Use History Counter")->currentValue == "true"; });
 
+  optionVector.emplace_back("Use Legal Move Generation", SearchConfig::USE_LEGAL_MOVE_GEN,
+                            [&](UciHandler*) { SearchConfig::USE_LEGAL_MOVE_GEN = getOption("Use Legal Move Generation")->currentValue == "true"; });
+
   optionVector.emplace_back("Use Mate Distance Pruning", SearchConfig::USE_MDP,
                             [&](UciHandler*) { SearchConfig::USE_MDP = getOption("Use Mate Distance Pruning")->currentValue == "true"; });
 
@@ -142,6 +183,7 @@ void UciOptions::initOptions() {
 
   optionVector.emplace_back("Use Pawn Hash", EvalConfig::USE_PAWN_TT,
                             [&](UciHandler*) { EvalConfig::USE_PAWN_TT = getOption("Use Pawn Hash")->currentValue == "true"; });
+#endif
 
   optionVector.emplace_back("Pawn Hash Size", EvalConfig::PAWN_TT_SIZE_MB, 0, 1024,
                             [&](UciHandler*) { EvalConfig::PAWN_TT_SIZE_MB = static_cast<Depth>(getInt(getOption("Pawn Hash Size")->currentValue)); });
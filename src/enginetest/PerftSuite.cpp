@@ -0,0 +1,136 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "PerftSuite.h"
+#include "chesscore/Perft.h"
+#include "common/Logging.h"
+#include "common/ThreadPool.h"
+
+#include <fmt/chrono.h>
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <stdexcept>
+
+PerftSuite::PerftSuite(const std::string& filePath, int maxDepth)
+    : filePath(filePath), maxDepth(maxDepth) {
+  if (maxDepth < 1) {
+    throw std::invalid_argument(fmt::format("Perft suite depth must be at least 1: {}", maxDepth));
+  }
+  LOG__INFO(Logger::get().TSUITE_LOG, "Preparing Perft Suite {}", filePath);
+  readTestCases(filePath, testCases);
+}
+
+bool PerftSuite::runPerftSuite(unsigned int threads) {
+  if (testCases.empty()) {
+    LOG__WARN(Logger::get().TSUITE_LOG, "No perft tests to run in {}", filePath);
+    return false;
+  }
+  if (threads == 0) {
+    threads = std::thread::hardware_concurrency() == 0 ? 4 : std::thread::hardware_concurrency();
+  }
+
+  fprintln("Running Perft Suite");
+  fprintln("==================================================================");
+  fprintln("EPD File:    {}", filePath);
+  fprintln("MaxDepth:    {}", maxDepth);
+  fprintln("Threads:     {}", threads);
+  fprintln("No of tests: {}", testCases.size());
+  fprintln("Date:        {:%Y-%m-%d %X}", fmt::localtime(time(nullptr)));
+  fprintln("");
+
+  const auto startTime = std::chrono::high_resolution_clock::now();
+  {
+    // positions are counted concurrently - each by its own single threaded perft
+    ThreadPool pool{threads};
+    std::vector<std::future<void>> results{};
+    for (PerftSuiteCase& test : testCases) {
+      results.push_back(pool.enqueue([&test, this] {
+        test.depth      = std::min(maxDepth, static_cast<int>(test.expected.size()));
+        const auto start = std::chrono::high_resolution_clock::now();
+        Perft perft(test.fen);
+        test.nodes   = perft.countNodes(test.depth);
+        test.time    = std::chrono::high_resolution_clock::now() - start;
+        test.success = test.nodes == test.expected[test.depth - 1];
+      }));
+    }
+    for (auto& result : results) result.get();
+  }
+  const nanoseconds wallTime = std::chrono::high_resolution_clock::now() - startTime;
+
+  uint64_t totalNodes = 0;
+  int failed          = 0;
+  fprintln(" {:<4s} | {:<7s} | {:<5s} | {:>15s} | {:>15s} | {:s}", " Nr.", "Result", "Depth", "Nodes", "Expected", "Fen");
+  fprintln("====================================================================================================================================");
+  for (std::size_t i = 0; i < testCases.size(); ++i) {
+    const PerftSuiteCase& test = testCases[i];
+    totalNodes += test.nodes;
+    if (!test.success) failed++;
+    fprintln(" {:<4d} | {:<7s} | {:<5d} | {:>15L} | {:>15L} | {:s}",
+             i + 1, test.success ? "Success" : "FAILED", test.depth, test.nodes, test.expected[test.depth - 1], test.fen);
+  }
+  fprintln("====================================================================================================================================");
+  fprintln("Summary:");
+  fprintln("EPD File:   {}", filePath);
+  fprintln("MaxDepth:   {}", maxDepth);
+  fprintln("Threads:    {}", threads);
+  fprintln("Successful: {:<3d}", testCases.size() - failed);
+  fprintln("Failed:     {:<3d}", failed);
+  fprintln("Nodes:      {:L}", totalNodes);
+  fprintln("Wall time:  {}", str(wallTime));
+  fprintln("NPS:        {:L}", nps(totalNodes, wallTime));
+  fprintln("");
+  return failed == 0;
+}
+
+void PerftSuite::readTestCases(const std::string& filePathStr, std::vector<PerftSuiteCase>& cases) {
+  std::ifstream file(filePathStr);
+  if (!file.is_open()) {
+    LOG__ERROR(Logger::get().TSUITE_LOG, "Could not open file: {}", filePathStr);
+    return;
+  }
+  std::string line;
+  while (getline(file, line)) {
+    const auto fenEnd = line.find(" D1 ");
+    if (fenEnd == std::string::npos) continue;
+    PerftSuiteCase test{};
+    test.fen  = line.substr(0, fenEnd);
+    test.line = line;
+    // results are given as "D<depth> <nodes>;" in order of depth
+    std::istringstream results(line.substr(fenEnd + 1));
+    std::string result;
+    while (getline(results, result, ';')) {
+      char d;
+      int depth;
+      uint64_t nodes;
+      if (!(std::istringstream(result) >> d >> depth >> nodes) || d != 'D'
+          || depth != static_cast<int>(test.expected.size()) + 1) {
+        break;
+      }
+      test.expected.push_back(nodes);
+    }
+    if (test.expected.empty()) {
+      LOG__WARN(Logger::get().TSUITE_LOG, "Invalid perft suite line: {}", line);
+      continue;
+    }
+    cases.push_back(test);
+  }
+}
@@ -0,0 +1,75 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef FRANKYCPP_PERFTSUITE_H
+#define FRANKYCPP_PERFTSUITE_H
+
+#include "types/types.h"
+
+#include "gtest/gtest_prod.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A PerftSuiteCase holds one position of a perft suite file with the
+// expected node counts for each depth (index 0 = depth 1) and the result
+// of the last run.
+struct PerftSuiteCase {
+  std::string fen{};
+  std::vector<uint64_t> expected{};
+  std::string line{};
+  int depth{};
+  uint64_t nodes{};
+  nanoseconds time{};
+  bool success{};
+};
+
+// PerftSuite runs all positions of a perft suite file (e.g.
+// test/testsets/perftsuite.epd) concurrently with bulk counting perft
+// and checks the number of nodes against the expected counts.
+// Lines have the format: <fen> D1 <nodes>; D2 <nodes>; ...
+class PerftSuite {
+
+  std::vector<PerftSuiteCase> testCases;
+  std::string filePath;
+  int maxDepth;
+
+public:
+  // Creates a PerftSuite for the given file and reads all positions.
+  // Each position is tested at maxDepth or at its deepest given depth
+  // if the line has fewer results.
+  // @throws std::invalid_argument if maxDepth is less than 1
+  PerftSuite(const std::string& filePath, int maxDepth);
+
+  // Runs all positions on the given number of threads (0 = all cores) and
+  // prints the results.
+  // @return true if all positions have the expected number of nodes
+  bool runPerftSuite(unsigned int threads = 0);
+
+  [[nodiscard]] const std::vector<PerftSuiteCase>& getTestCases() const { return testCases; }
+
+private:
+  // reads all lines of the file into test cases - skips lines without results
+  static void readTestCases(const std::string& filePathStr, std::vector<PerftSuiteCase>& cases);
+
+  FRIEND_TEST(PerftSuiteTest, readFile);
+};
+
+#endif//FRANKYCPP_PERFTSUITE_H
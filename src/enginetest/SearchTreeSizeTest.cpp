@@ -160,6 +160,52 @@ Result SearchTreeSizeTest::featureMeasurements(int d, milliseconds mt, const std
   //  SearchConfig::USE_THREAT_EXT = true;
   //  result.tests.push_back(measureTreeSize(search, position, searchLimits, "71 TEXT"));
 
+  // TT entry format - compact entries have 50% more entries per MB
+  // which shows best with a small TT compared to the tree size
+  SearchConfig::TT_COMPACT = true;
+  search.resizeTT();
+  result.tests.push_back(measureTreeSize(search, position, searchLimits, "80 TT Compact"));
+
+  SearchConfig::TT_COMPACT = false;
+  SearchConfig::TT_SIZE_MB = 4;
+  search.resizeTT();
+  result.tests.push_back(measureTreeSize(search, position, searchLimits, "81 TT 4MB"));
+
+  SearchConfig::TT_COMPACT = true;
+  search.resizeTT();
+  result.tests.push_back(measureTreeSize(search, position, searchLimits, "82 TT 4MB Comp"));
+
+  SearchConfig::TT_COMPACT = false;
+  SearchConfig::TT_SIZE_MB = 64;
+  search.resizeTT();
+
+  return result;
+}
+
+Result SearchTreeSizeTest::threadMeasurements(int d, milliseconds mt, const std::string& fen) {
+  Search search{};
+  SearchLimits searchLimits{};
+  searchLimits.depth = d;
+  if (mt != milliseconds::zero()) {
+    searchLimits.moveTime    = mt;
+    searchLimits.timeControl = true;
+  }
+  Result result(fen);
+  Position position(fen);
+
+  // all search features as configured - only no book and pondering
+  SearchConfig::USE_BOOK   = false;
+  SearchConfig::USE_PONDER = false;
+
+  ptrToSpecial1 = nullptr;
+  ptrToSpecial2 = nullptr;
+
+  for (int threads : {1, 2, 4, 8, 16}) {
+    SearchConfig::THREADS = threads;
+    result.tests.push_back(measureTreeSize(search, position, searchLimits, fmt::format("{:02d} Threads", threads)));
+  }
+  SearchConfig::THREADS = 1;
+
   return result;
 }
 
@@ -182,6 +228,46 @@ void SearchTreeSizeTest::start() {
     results.push_back(featureMeasurements(depth, movetime, fen));
   }
 
+  printResults();
+}
+
+void SearchTreeSizeTest::startThreadScaling() {
+
+  fprintln("Start Search Thread Scaling Test for depth {}", depth);
+
+  // Prepare test fens
+  results.clear();
+  results.reserve(fens.size());
+
+  // Execute tests and store results
+  for (auto& fen : fens) {
+    try {
+      Position testPosition(fen);
+    } catch (std::invalid_argument& e) {
+      std::cerr << fmt::format("Invalid fen skipped: {} ({})", e.what(), fen) << std::endl;
+      continue;
+    }
+    results.push_back(threadMeasurements(depth, movetime, fen));
+  }
+
+  auto sums = printResults();
+
+  // speedup compared to single thread search
+  // time to depth is only meaningful for depth limited searches
+  const auto& single = sums["01 Threads"];
+  if (!single.sumCounter || !single.sumTime || !single.sumNps) {
+    return;
+  }
+  fmt::print("\n################## Lazy SMP scaling compared to 1 thread ##################\n\n");
+  for (auto& sum : sums) {
+    if (!sum.second.sumTime) continue;
+    fprintln("Test: {:<12s}  Speedup (time to depth): {:>6.2f}  Nps scaling: {:>6.2f}", sum.first.c_str(),
+             static_cast<double>(single.sumTime) / static_cast<double>(sum.second.sumTime),
+             static_cast<double>(sum.second.sumNps) / static_cast<double>(single.sumNps));
+  }
+}
+
+std::map<std::string, TestSums> SearchTreeSizeTest::printResults() {
   // Print result
   NEWLINE;
   fmt::print("################## Results for depth {} ##########################\n", depth);
@@ -225,11 +311,14 @@ void SearchTreeSizeTest::start() {
   fmt::print("Total tests            : {:d}\n\n", results[0].tests.size() * fens.size());
 
   for (auto& sum : sums) {
-    fprintln("Test: {:<12s}  Nodes: {:>16L}  Nps: {:>16L}  Time: {:>16L} Depth: {:>3d}/{:<3d} Special1: {:>16L} Special2: {:>16L}", sum.first.c_str(),
+    fprintln("Test: {:<12s}  Nodes: {:>16L}  Nps: {:>16L}  Time: {:>16L} Depth: {:>3d}/{:<3d} Special1: {:>16L} Special2: {:>16L} ({:>3d}%)", sum.first.c_str(),
              sum.second.sumNodes / sum.second.sumCounter, sum.second.sumNps / sum.second.sumCounter,
              (sum.second.sumTime / 1'000'000) / sum.second.sumCounter, sum.second.sumDepth / sum.second.sumCounter, sum.second.sumExtra / sum.second.sumCounter,
-             sum.second.special1 / sum.second.sumCounter, sum.second.special2 / sum.second.sumCounter);
+             sum.second.special1 / sum.second.sumCounter, sum.second.special2 / sum.second.sumCounter,
+             sum.second.special1 + sum.second.special2 ? (100 * sum.second.special1) / (sum.second.special1 + sum.second.special2) : 0);
   }
+
+  return sums;
 }
 
 SingleTest SearchTreeSizeTest::measureTreeSize(Search& search, const Position& position,
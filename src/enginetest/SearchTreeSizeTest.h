@@ -20,6 +20,7 @@
 #ifndef FRANKYCPP_SEARCHTREESIZETEST_H
 #define FRANKYCPP_SEARCHTREESIZETEST_H
 
+#include <map>
 #include <string>
 #include <utility>
 #include <vector>
@@ -77,8 +78,15 @@ public:
 
   void start();
 
+  // measures the search with 1, 2, 4, 8 and 16 threads (Lazy SMP)
+  // and reports the speedup (time to depth) and nps scaling compared
+  // to a single thread search.
+  void startThreadScaling();
+
 private:
   Result featureMeasurements(int d, milliseconds mt, const std::string& fen);
+  Result threadMeasurements(int d, milliseconds mt, const std::string& fen);
+  std::map<std::string, TestSums> printResults();
   SingleTest measureTreeSize(Search& search, const Position& position, SearchLimits searchLimits, const std::string& featureName) const;
 };
 
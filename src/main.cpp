@@ -22,6 +22,7 @@
 #include <chesscore/Perft.h>
 #include <engine/SearchConfig.h>
 #include <engine/UciHandler.h>
+#include <enginetest/PerftSuite.h>
 #include <enginetest/TestSuite.h>
 #include <fstream>
 #include <iostream>
@@ -44,8 +45,8 @@ int main(int argc, char* argv[]) {
     .append(std::to_string(FrankyCPP_VERSION_MINOR));
   std::cout << appName << std::endl;
 
-  std::string config_file, book_file, book_type, testsuite_file;
-  int testsuite_time, testsuite_depth, perftStart, perftEnd;
+  std::string config_file, book_file, book_type, testsuite_file, perftsuite_file;
+  int testsuite_time, testsuite_depth, perftStart, perftEnd, threads, perftHash, perftsuite_depth;
 
   // Command line options
   try {
@@ -63,15 +64,23 @@ int main(int argc, char* argv[]) {
     config.add_options()
       ("log_lvl,l", po::value<std::string>()->default_value("warn"), "set general log level <critical|error|warn|info|debug|trace>")
       ("search_log_lvl,s", po::value<std::string>()->default_value("warn"), "set search log level <critical|error|warn|info|debug|trace>")
+      ("log_async", po::value<bool>()->default_value(false), "write search and book logs from a background thread")
+      ("log_queue_size", po::value<int>()->default_value(8'192), "number of pre-allocated messages for async logging")
+      ("log_overflow", po::value<std::string>()->default_value("block"), "async logging when the queue is full <block|drop>")
       ("nobook", "do not use opening book")
       ("book,b", po::value<std::string>(&book_file), "opening book to use")
       ("booktype,t", po::value<std::string>(&book_type), "type of opening book <simple|san|pgn>")
       ("testsuite", po::value<std::string>(&testsuite_file), "run testsuite in given file")
       ("tsTime", po::value<int>(&testsuite_time)->default_value(1'000), "time in ms per test in testsuite")
       ("tsDepth", po::value<int>(&testsuite_depth)->default_value(0), "max search depth per test in testsuite")
-      ("perft", "run perft test")
+      ("perft", "run perft test (counts nodes only - see perftDetails)")
+      ("perftDetails", "count captures, checks, mates, etc. in perft test (slow)")
       ("startDepth", po::value<int>(&perftStart)->default_value(1), "start depth for perft test")
-      ("endDepth", po::value<int>(&perftEnd)->default_value(5), "end depth for perft test");
+      ("endDepth", po::value<int>(&perftEnd)->default_value(5), "end depth for perft test")
+      ("threads", po::value<int>(&threads)->default_value(1), "number of threads for perft test and perft suite (suite uses all cores if not given or 0)")
+      ("perftHash", po::value<int>(&perftHash)->default_value(0), "size of perft hash in MB (0 = no hash)")
+      ("perftsuite", po::value<std::string>(&perftsuite_file), "run all positions of the given perft suite file (e.g. perftsuite.epd)")
+      ("depth", po::value<int>(&perftsuite_depth)->default_value(5), "max perft depth per position in perft suite");
 
     // Hidden options, will be allowed both on command line and in config file,
     // but will not be shown to the user when printing help.
@@ -164,6 +173,30 @@ int main(int argc, char* argv[]) {
       return 0;
     }
 
+    // Perft suite run from cmd line - exit code 1 if any position fails
+    if (programOptions.count("perftsuite")) {
+      init::init();
+      std::cout << "RUNNING PERFT SUITE\n";
+      std::cout << "########################################################\n";
+      std::cout << "Version: " << appName << "\n";
+      if (!std::filesystem::exists(perftsuite_file)) {
+        std::cerr << "Could not read file: " << perftsuite_file << "\n";
+        return 1;
+      }
+      if (perftsuite_depth < 1) {
+        std::cerr << "Perft suite depth must be at least 1: " << perftsuite_depth << "\n";
+        return 1;
+      }
+      if (threads < 0) {
+        std::cerr << "Number of threads must not be negative: " << threads << "\n";
+        return 1;
+      }
+      PerftSuite perftSuite{perftsuite_file, perftsuite_depth};
+      // all cores unless a number of threads is given (0 = all cores)
+      const unsigned int suiteThreads = programOptions["threads"].defaulted() ? 0 : static_cast<unsigned int>(threads);
+      return perftSuite.runPerftSuite(suiteThreads) ? 0 : 1;
+    }
+
     // Perft run from cmd line
     if (programOptions.count("perft")) {
       init::init();
@@ -173,8 +206,13 @@ int main(int argc, char* argv[]) {
       std::cout << "Version: " << appName << "\n";
       std::cout << "Start depth: " << fmt::format("{:L}", perftStart) << "\n";
       std::cout << "End depth  : " << fmt::format("{:L}", perftEnd) << "\n";
+      std::cout << "Threads    : " << fmt::format("{:L}", threads) << "\n";
+      std::cout << "Hash       : " << fmt::format("{:L}", perftHash) << " MB\n";
       std::cout << std::endl;
       Perft perft{};
+      perft.setBulkCounting(!programOptions.count("perftDetails"));
+      perft.setThreads(threads);
+      perft.setHashSize(static_cast<std::size_t>(std::max(0, perftHash)));
       perft.perft(perftStart, perftEnd, true);
       return 0;
     }
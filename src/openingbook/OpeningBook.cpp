@@ -158,8 +158,7 @@ std::vector<std::string_view> OpeningBook::readFile(const std::string& filePath)
 
   std::fstream file(filePath, std::ios::in | std::ios::binary);
   if (file.is_open()) {
-    const uint64_t fileSize = std::filesystem::file_size(filePath);
-    LOG__DEBUG(Logger::get().BOOK_LOG, "Opened Opening Book '{}' with {:L} Byte successful.", filePath, fileSize);
+    LOG__DEBUG(Logger::get().BOOK_LOG, "Opened Opening Book '{}' with {:L} Byte successful.", filePath, std::filesystem::file_size(filePath));
 
     // fast way to read all lines from a file into memory
     // https://stackoverflow.com/a/52699885/9161706
@@ -217,7 +216,7 @@ void OpeningBook::readGames(const std::vector<std::string_view>& lines) {
 }
 
 void OpeningBook::readGamesSimple(const std::vector<std::string_view>& lines) {
-  const unsigned int noOfThreads = getNoOfThreads();
+  [[maybe_unused]] const unsigned int noOfThreads = getNoOfThreads();
 
 #ifdef PARALLEL_LINE_PROCESSING
   LOG__DEBUG(Logger::get().BOOK_LOG, "Using {} threads", noOfThreads);
@@ -282,7 +281,7 @@ void OpeningBook::readOneGameSimple(const std::string_view& lineView) {
 }
 
 void OpeningBook::readGamesSan(const std::vector<std::string_view>& lines) {
-  const unsigned int noOfThreads = getNoOfThreads();
+  [[maybe_unused]] const unsigned int noOfThreads = getNoOfThreads();
 #ifdef PARALLEL_LINE_PROCESSING
   LOG__DEBUG(Logger::get().BOOK_LOG, "Using {} threads", noOfThreads);
 
@@ -667,7 +666,6 @@ bool OpeningBook::hasCache() const {
     LOG__DEBUG(Logger::get().BOOK_LOG, "No cache file {} available", serCacheFile);
     return false;
   }
-  uint64_t fsize = std::filesystem::file_size(serCacheFile);
-  LOG__DEBUG(Logger::get().BOOK_LOG, "Cache file {} ({:L} kB) available", serCacheFile, fsize / 1'024);
+  LOG__DEBUG(Logger::get().BOOK_LOG, "Cache file {} ({:L} kB) available", serCacheFile, std::filesystem::file_size(serCacheFile) / 1'024);
   return true;
 }
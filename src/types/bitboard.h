@@ -187,6 +187,20 @@ inline Bitboard shiftBb(Direction d, Bitboard b) {
   return b;
 }
 
+// shiftBb for a direction known at compile time - no switch at runtime
+template<Direction d>
+constexpr Bitboard shiftBb(Bitboard b) {
+  if constexpr (d == NORTH) return b << 8;
+  else if constexpr (d == EAST) return (b << 1) & ~FileABB;
+  else if constexpr (d == SOUTH) return b >> 8;
+  else if constexpr (d == WEST) return (b >> 1) & ~FileHBB;
+  else if constexpr (d == NORTH_EAST) return (b << 9) & ~FileABB;
+  else if constexpr (d == SOUTH_EAST) return (b >> 7) & ~FileABB;
+  else if constexpr (d == SOUTH_WEST) return (b >> 9) & ~FileHBB;
+  else if constexpr (d == NORTH_WEST) return (b << 7) & ~FileHBB;
+  else return b;
+}
+
 // if C++20 feature library <bit> is available, use the new bit operations
 #if __cpp_lib_bitops >= 201907L
 #include <bit>
@@ -34,6 +34,16 @@
 #define DEBUG(...) std::cout << fmt::format(deLocale, "DEBUG {}:{} {}", __FILE__, __LINE__, __VA_ARGS__) << std::endl
 #define TICK(tp) fprintln("{:L} ns: function: {}() line: {}", elapsedSince(tp).count(), __FUNCTION__, __LINE__)
 
+// Search and evaluation features (SearchConfig, EvalConfig) are variables
+// in the default experiment build so they can be changed by UCI options
+// and tests. A tournament build freezes them to their defaults as compile
+// time constants which lets the compiler remove disabled code paths.
+#ifdef TOURNAMENT_BUILD
+#define CONFIG_FEATURE constexpr
+#else
+#define CONFIG_FEATURE inline
+#endif
+
 // These are convenience macros to define custom operators on our types.
 // This idea and code is taken from Stockfish
 #define ENABLE_BASE_OPERATORS_ON(T)                                                                         \
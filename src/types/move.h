@@ -233,4 +233,21 @@ struct moveValueGreaterComparator {
   }
 };
 
+// Sorts moves by their sort value (highest first) and keeps the order of
+// moves with equal values like std::stable_sort. Other than std::stable_sort
+// this never allocates a temporary buffer. Move lists are short so an
+// insertion sort is fast enough.
+template<typename Iterator>
+constexpr void sortMovesByValue(Iterator first, Iterator last) {
+  const moveValueGreaterComparator greater{};
+  for (Iterator i = first; i != last; ++i) {
+    const Move move = *i;
+    Iterator j      = i;
+    for (; j != first && greater(move, *(j - 1)); --j) {
+      *j = *(j - 1);
+    }
+    *j = move;
+  }
+}
+
 #endif//FRANKYCPP_MOVE_H
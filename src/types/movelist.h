@@ -20,12 +20,121 @@
 #ifndef FRANKYCPP_MOVELIST_H
 #define FRANKYCPP_MOVELIST_H
 
-#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
 #include <sstream>
 #include "move.h"
 
-/// A collection of moves using a std::vector
-typedef std::vector<Move> MoveList;
+// max number of moves in a single position is 218 - the capacity
+// of a MoveList also covers lines up to the max search depth
+constexpr const std::size_t MAX_MOVES_PER_LIST = 256;
+
+/// A collection of moves with a fixed capacity stored inline without
+/// any heap allocation. Provides the part of the std::vector interface
+/// used in the engine. Copies only copy the used part of the list.
+/// Exceeding the capacity is a programming error and is only
+/// checked with asserts.
+class MoveList {
+  // not std::size_t (same type as Move's underlying type) so that
+  // writing moves can't alias the counter
+  uint32_t count = 0;
+  Move moves[MAX_MOVES_PER_LIST];
+
+public:
+  using value_type      = Move;
+  using size_type       = std::size_t;
+  using reference       = Move&;
+  using const_reference = const Move&;
+  using iterator        = Move*;
+  using const_iterator  = const Move*;
+
+  // the moves are intentionally not initialized (also not by MoveList{})
+  MoveList() {}
+
+  MoveList(std::initializer_list<Move> list) {
+    assert(list.size() <= MAX_MOVES_PER_LIST && "MoveList capacity exceeded");
+    std::copy(list.begin(), list.end(), moves);
+    count = static_cast<uint32_t>(list.size());
+  }
+
+  MoveList(const MoveList& other) : count(other.count) {
+    std::copy(other.begin(), other.end(), moves);
+  }
+
+  MoveList& operator=(const MoveList& other) {
+    if (this != &other) {
+      count = other.count;
+      std::copy(other.begin(), other.end(), moves);
+    }
+    return *this;
+  }
+
+  inline void push_back(const Move move) {
+    assert(count < MAX_MOVES_PER_LIST && "MoveList capacity exceeded");
+    moves[count++] = move;
+  }
+
+  inline void emplace_back(const Move move) { push_back(move); }
+
+  inline void pop_back() {
+    assert(count > 0 && "MoveList is empty");
+    --count;
+  }
+
+  // inserts the moves [first, last) before pos
+  template<class InputIt>
+  iterator insert(const_iterator pos, InputIt first, InputIt last) {
+    const auto index = static_cast<std::size_t>(pos - begin());
+    const auto n     = static_cast<std::size_t>(std::distance(first, last));
+    assert(count + n <= MAX_MOVES_PER_LIST && "MoveList capacity exceeded");
+    std::copy_backward(moves + index, moves + count, moves + count + n);
+    std::copy(first, last, moves + index);
+    count += static_cast<uint32_t>(n);
+    return moves + index;
+  }
+
+  inline void clear() { count = 0; }
+
+  inline std::size_t size() const { return count; }
+  inline bool empty() const { return count == 0; }
+  static constexpr std::size_t capacity() { return MAX_MOVES_PER_LIST; }
+
+  inline Move& operator[](const std::size_t i) { return moves[i]; }
+  inline const Move& operator[](const std::size_t i) const { return moves[i]; }
+
+  inline Move& at(const std::size_t i) {
+    assert(i < count && "MoveList index out of range");
+    return moves[i];
+  }
+  inline const Move& at(const std::size_t i) const {
+    assert(i < count && "MoveList index out of range");
+    return moves[i];
+  }
+
+  inline Move& front() { return moves[0]; }
+  inline const Move& front() const { return moves[0]; }
+  inline Move& back() { return moves[count - 1]; }
+  inline const Move& back() const { return moves[count - 1]; }
+
+  inline iterator begin() { return moves; }
+  inline iterator end() { return moves + count; }
+  inline const_iterator begin() const { return moves; }
+  inline const_iterator end() const { return moves + count; }
+  inline const_iterator cbegin() const { return moves; }
+  inline const_iterator cend() const { return moves + count; }
+
+  inline Move* data() { return moves; }
+  inline const Move* data() const { return moves; }
+
+  bool operator==(const MoveList& other) const {
+    return count == other.count && std::equal(begin(), end(), other.begin());
+  }
+  bool operator!=(const MoveList& other) const { return !(*this == other); }
+};
 
 // returns a uci compatible string representation of the move list
 inline std::string str(const MoveList& moveList) {
@@ -0,0 +1,86 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.h"
+
+namespace {
+  // number of active AllocationCounter instances
+  std::atomic<int> activeCounters{0};
+  // allocations while at least one counter was active
+  std::atomic<uint64_t> allocationCount{0};
+
+  void* countedAllocation(std::size_t size) {
+    if (activeCounters.load(std::memory_order_relaxed)) {
+      allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+  }
+}// namespace
+
+AllocationCounter::AllocationCounter() {
+  activeCounters++;
+  startCount = allocationCount.load();
+}
+
+AllocationCounter::~AllocationCounter() {
+  activeCounters--;
+}
+
+uint64_t AllocationCounter::allocations() const {
+  return allocationCount.load() - startCount;
+}
+
+// Replacements of the global allocation functions for the whole test
+// executable. Aligned versions are not replaced as the default ones
+// do not call these.
+void* operator new(std::size_t size) {
+  return countedAllocation(size);
+}
+
+void* operator new[](std::size_t size) {
+  return countedAllocation(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return countedAllocation(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return countedAllocation(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
@@ -0,0 +1,52 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef FRANKYCPP_ALLOCATIONCOUNTER_H
+#define FRANKYCPP_ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+/**
+ * Counts heap allocations in tests.
+ *
+ * The test executable replaces the global operator new (see
+ * AllocationCounter.cpp) which counts all allocations while at least one
+ * AllocationCounter is alive. Allocations of all threads are counted.
+ *
+ * Usage:
+ *   AllocationCounter counter{};
+ *   ... code under test ...
+ *   EXPECT_EQ(0, counter.allocations());
+ */
+class AllocationCounter {
+  uint64_t startCount;
+
+public:
+  AllocationCounter();
+  ~AllocationCounter();
+
+  // disallow copies
+  AllocationCounter(AllocationCounter const&) = delete;
+  AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+  /** Number of allocations since this counter has been created */
+  uint64_t allocations() const;
+};
+
+#endif//FRANKYCPP_ALLOCATIONCOUNTER_H
@@ -708,6 +708,30 @@ TEST_F(MoveGenTest, evasion) {
   fprintln("");
 }
 
+TEST_F(MoveGenTest, legalModes) {
+  // both legal modes must generate the same moves in the same order
+  const std::vector<std::string> fens = {
+    START_POSITION_FEN,
+    "r3k2r/1pp4p/2q1qNn1/3nP3/2q1Pp2/B5R1/pbp2PPP/1R4K1 b kq -",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+    "5k2/8/8/8/8/8/6p1/3K1R2 b - -",
+    "8/8/8/3k4/4Pp2/8/8/3K4 b - e3",
+    "8/8/3p4/KPp4r/1R3p1k/8/4P1P1/8 w - c6",
+    "5k2/3N4/8/8/8/8/6p1/3K1R2 b - - 1 1",
+    "4k3/4q3/8/8/1b2P3/8/3N4/4KBNr w - -",
+  };
+  MoveGenerator mgDoMove;
+  MoveGenerator mgMasks;
+  mgDoMove.setLegalMode(LegalByDoMove);
+  EXPECT_EQ(LegalByMasks, mgMasks.getLegalMode());
+  for (const auto& fen : fens) {
+    Position p(fen);
+    const MoveList* byDoMove = mgDoMove.generateLegalMoves(p, GenAll);
+    const MoveList* byMasks  = mgMasks.generateLegalMoves(p, GenAll);
+    EXPECT_EQ(*byDoMove, *byMasks) << fen;
+  }
+}
+
 TEST_F(MoveGenTest, sortValueTest) {
   MoveGenerator mg;
   Position p;
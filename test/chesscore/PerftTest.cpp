@@ -22,9 +22,13 @@
 #include "chesscore/Position.h"
 #include "init.h"
 #include "types/types.h"
+#include "version.h"
 #include <gtest/gtest.h>
+#include <fstream>
 #include <ostream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 using namespace std;
 using testing::Eq;
@@ -42,6 +46,104 @@ protected:
   void TearDown() override {}
 };
 
+TEST_F(PerftTest, perftSuiteLegal) {
+  // all positions of the perft suite with the legal move generator
+  // up to the depth with a reasonable number of nodes
+  std::string filePath = FrankyCPP_PROJECT_ROOT;
+  filePath += "/test/testsets/perftsuite.epd";
+  std::ifstream file(filePath);
+  ASSERT_TRUE(file.is_open()) << filePath;
+
+  uint64_t maxNodes = 1'000'000;
+#ifndef NDEBUG
+  maxNodes = 50'000;
+#endif
+
+  int positions = 0;
+  std::string line;
+  while (std::getline(file, line)) {
+    const auto fenEnd = line.find(" D1 ");
+    if (fenEnd == std::string::npos) continue;
+    Perft p(line.substr(0, fenEnd));
+    p.setLegalMoveGen(true);
+    positions++;
+    // results are given as "D<depth> <nodes>;"
+    std::istringstream results(line.substr(fenEnd + 1));
+    std::string result;
+    while (std::getline(results, result, ';')) {
+      int depth;
+      uint64_t nodes;
+      char d;
+      std::istringstream(result) >> d >> depth >> nodes;
+      if (nodes > maxNodes) break;
+      p.perft(depth);
+      EXPECT_EQ(nodes, p.getNodes()) << line << " depth " << depth;
+    }
+  }
+  EXPECT_EQ(126, positions);
+}
+
+TEST_F(PerftTest, bulkPerft) {
+  // bulk counting only counts nodes
+  struct PerftResult {
+    std::string fen;
+    int depth;
+    uint64_t nodes;
+  };
+  // @formatter:off
+  std::vector<PerftResult> results = {
+    { START_POSITION_FEN,                                                       5,     4'865'609ULL },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",      4,     4'085'603ULL },
+    { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -",                                 6,    11'030'083ULL },
+    { "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",      5,    15'833'292ULL },
+    { "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",      5,    15'833'292ULL },
+    { "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ -",                 4,     2'103'487ULL },
+  };
+  // @formatter:on
+#ifndef NDEBUG
+  for (auto& r : results) {
+    if (r.nodes > 5'000'000) r.depth = 0;
+  }
+#endif
+
+  for (const auto& r : results) {
+    if (!r.depth) continue;
+    Perft p(r.fen);
+    p.setBulkCounting(true);
+    p.perft(r.depth);
+    EXPECT_EQ(r.nodes, p.getNodes()) << r.fen;
+    EXPECT_EQ(0, p.getCaptureCounter());
+  }
+}
+
+TEST_F(PerftTest, parallelPerft) {
+  int depth = 5;
+#ifndef NDEBUG
+  depth = 4;
+#endif
+  // detailed counters are summed up from all threads
+  Perft serial;
+  serial.perft(depth, true);
+  Perft parallel;
+  parallel.setThreads(4);
+  parallel.perft(depth, true);
+  EXPECT_EQ(serial.getNodes(), parallel.getNodes());
+  EXPECT_EQ(serial.getCaptureCounter(), parallel.getCaptureCounter());
+  EXPECT_EQ(serial.getEnpassantCounter(), parallel.getEnpassantCounter());
+  EXPECT_EQ(serial.getCheckCounter(), parallel.getCheckCounter());
+  EXPECT_EQ(serial.getCheckMateCounter(), parallel.getCheckMateCounter());
+  EXPECT_EQ(serial.getCastleCounter(), parallel.getCastleCounter());
+  EXPECT_EQ(serial.getPromotionCounter(), parallel.getPromotionCounter());
+
+  // bulk counting with a shared hash
+  Perft kiwiPete("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -");
+  kiwiPete.setBulkCounting(true);
+  kiwiPete.setThreads(4);
+  kiwiPete.setHashSize(16);
+  kiwiPete.perft(1, depth, true);
+  EXPECT_EQ(depth == 5 ? 193'690'690ULL : 4'085'603ULL, kiwiPete.getNodes());
+}
+
 TEST_F(PerftTest, stdPerftOD) {
   MoveGenerator mg;
   Position position;
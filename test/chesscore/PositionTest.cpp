@@ -21,6 +21,7 @@
 #include <ostream>
 #include <string>
 
+#include "chesscore/MoveGenerator.h"
 #include "chesscore/Position.h"
 #include "init.h"
 
@@ -57,7 +58,29 @@ TEST_F(PositionTest, HistoryStruct) {
   fprintln("Flag:           {}", sizeof(Flag));
   fprintln("History: {}", sizeof(HistoryState));
 //  EXPECT_EQ(32, sizeof(HistoryState));
-  EXPECT_EQ(MAX_MOVES, position.historyState.size());
+  fprintln("Position: {}", sizeof(Position));
+  EXPECT_TRUE(position.historyState.empty());
+  EXPECT_LE(sizeof(Position), 1024);
+
+  // history grows as needed beyond the previous fixed MAX_MOVES entries
+  const Move e2e4 = createMove(SQ_E2, SQ_E4, NORMAL);
+  for (int i = 0; i < MAX_MOVES + 10; ++i) position.doNullMove();
+  position.doMove(e2e4);
+  EXPECT_EQ(MAX_MOVES + 11, position.historyState.size());
+  EXPECT_EQ(e2e4, position.getLastMove());
+
+  // a copy only copies the used history but reserves room for a search line
+  Position copy(position);
+  EXPECT_EQ(position.historyState.size(), copy.historyState.size());
+  EXPECT_GE(copy.historyState.capacity(), copy.historyState.size() + MAX_DEPTH);
+  EXPECT_EQ(e2e4, copy.getLastMove());
+  copy.undoMove();
+  EXPECT_EQ(MOVE_NONE, copy.getLastMove());
+  EXPECT_EQ(e2e4, position.getLastMove());
+
+  for (int i = 0; i < MAX_MOVES + 10; ++i) copy.undoNullMove();
+  EXPECT_TRUE(copy.historyState.empty());
+  EXPECT_EQ(Position().strFen(), copy.strFen());
 }
 
 TEST_F(PositionTest, ZobristTest) {
@@ -1000,6 +1023,76 @@ TEST_F(PositionTest, isLegalMove) {
   EXPECT_FALSE(position.isLegalMove(createMove(SQ_E8, SQ_C8, CASTLING)));
 }
 
+TEST_F(PositionTest, isPseudoLegalMove) {
+  // every possible move must be pseudo legal if and only if
+  // the move generator generates it
+  const std::vector<std::string> fens = {
+    START_POSITION_FEN,
+    "r3k2r/1ppn3p/2q1q1n1/8/2q1Pp2/B5R1/p1p2PPP/1R4K1 b kq e3",
+    "r3k2r/1ppn3p/2q1qNn1/8/2q1Pp2/B5R1/p1p2PPP/1R4K1 b kq e3",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq -",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ -",
+  };
+  MoveGenerator mg;
+  for (const auto& fen : fens) {
+    Position position(fen);
+    const MoveList* moves = mg.generatePseudoLegalMoves(position, GenAll);
+    int found = 0;
+    for (Square from = SQ_A1; from <= SQ_H8; ++from) {
+      for (Square to = SQ_A1; to <= SQ_H8; ++to) {
+        for (MoveType mt : {NORMAL, PROMOTION, ENPASSANT, CASTLING}) {
+          for (PieceType pt : {KNIGHT, BISHOP, ROOK, QUEEN}) {
+            if (mt != PROMOTION && pt != KNIGHT) continue;
+            const Move move     = createMove(from, to, mt, pt);
+            const bool expected = std::find_if(moves->begin(), moves->end(), [&](Move m) { return moveOf(m) == move; }) != moves->end();
+            EXPECT_EQ(expected, position.isPseudoLegalMove(move)) << fen << " " << str(move);
+            if (expected) found++;
+          }
+        }
+      }
+    }
+    EXPECT_EQ(moves->size(), found) << fen;
+  }
+}
+
+TEST_F(PositionTest, pinnedPieces) {
+  // white: Nd2 pinned by Bb4, e4 pawn pinned by Qe7, Bf1 and Ng1 not pinned (two pieces on the line)
+  Position position("4k3/4q3/8/8/1b2P3/8/3N4/4KBNr w - -");
+  EXPECT_EQ(Bitboards::sqBb[SQ_D2] | Bitboards::sqBb[SQ_E4], position.pinnedPieces(WHITE));
+  EXPECT_EQ(BbZero, position.pinnedPieces(BLACK));
+  // own and opponent piece between king and slider - no pin
+  position = Position("4k3/4q3/4p3/8/4P3/8/8/4K3 w - -");
+  EXPECT_EQ(BbZero, position.pinnedPieces(WHITE));
+}
+
+TEST_F(PositionTest, isLegalMoveWithMasks) {
+  // the mask based legality test must agree with making the move for all
+  // evasion or pseudo legal moves
+  const std::vector<std::string> fens = {
+    START_POSITION_FEN,
+    "r3k2r/1ppn3p/2q1q1n1/8/2q1Pp2/B5R1/p1p2PPP/1R4K1 b kq e3",
+    "r3k2r/1ppn3p/2q1qNn1/8/2q1Pp2/B5R1/p1p2PPP/1R4K1 b kq e3",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -",
+    "8/8/3p4/KPp4r/1R3p1k/8/4P1P1/8 w - c6",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq -",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ -",
+    "4k3/4q3/8/8/1b2P3/8/3N4/4KBNr w - -",
+    "4k3/8/8/8/1b6/8/3N4/r3K3 w - -",
+  };
+  MoveGenerator mg;
+  for (const auto& fen : fens) {
+    Position position(fen);
+    const Bitboard pinned = position.pinnedPieces(position.getNextPlayer());
+    const MoveList moves  = *mg.generatePseudoLegalMoves(position, GenAll, position.hasCheck());
+    for (Move move : moves) {
+      EXPECT_EQ(position.isLegalMove(move), position.isLegalMove(move, pinned)) << fen << " " << str(move);
+    }
+  }
+}
+
 TEST_F(PositionTest, wasLegalMove) {
   string fen;
   Position position;
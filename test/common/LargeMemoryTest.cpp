@@ -0,0 +1,141 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "init.h"
+#include "types/types.h"
+#include "common/Logging.h"
+#include "common/LargeMemory.h"
+
+#include <gtest/gtest.h>
+using testing::Eq;
+
+class LargeMemoryTest : public ::testing::Test {
+public:
+  static void SetUpTestSuite() {
+    NEWLINE;
+    init::init();
+    NEWLINE;
+    Logger::get().TEST_LOG->set_level(spdlog::level::debug);
+  }
+
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(LargeMemoryTest, zero) {
+  LargeMemory memory;
+  EXPECT_EQ(nullptr, memory.allocate(0, true, false));
+  EXPECT_EQ(0, memory.getPageSize());
+}
+
+TEST_F(LargeMemoryTest, largePages) {
+  LargeMemory memory;
+  const std::size_t size = 64 * MB;
+  auto* p = static_cast<uint8_t*>(memory.allocate(size, true, false));
+  ASSERT_NE(nullptr, p);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % LargeMemory::ALIGNMENT);
+  EXPECT_GE(memory.getPageSize(), 4096);
+  LOG__INFO(Logger::get().TEST_LOG, "Large pages: {}", memory.str());
+  // transparent huge pages are only requested - the page size is not claimed
+  if (memory.isHugePagesAdvised()) {
+    EXPECT_LT(memory.getPageSize(), 1 * MB);
+    EXPECT_NE(std::string::npos, memory.str().find("THP requested"));
+  }
+  std::memset(p, 0xFF, size);
+  EXPECT_EQ(0xFF, p[size - 1]);
+  memory.release();
+  EXPECT_EQ(0, memory.getPageSize());
+}
+
+TEST_F(LargeMemoryTest, smallPages) {
+  LargeMemory memory;
+  const std::size_t size = 1 * MB;
+  auto* p = static_cast<uint8_t*>(memory.allocate(size, false, false));
+  ASSERT_NE(nullptr, p);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % LargeMemory::ALIGNMENT);
+  LOG__INFO(Logger::get().TEST_LOG, "Small pages: {}", memory.str());
+  std::memset(p, 0xFF, size);
+  EXPECT_EQ(0xFF, p[0]);
+}
+
+TEST_F(LargeMemoryTest, interleaved) {
+  LargeMemory memory;
+  const std::size_t size = 16 * MB;
+  auto* p = static_cast<uint8_t*>(memory.allocate(size, true, true));
+  ASSERT_NE(nullptr, p);
+  // interleaving might not be possible (e.g. no NUMA support) but must not fail
+  LOG__INFO(Logger::get().TEST_LOG, "Interleaved: {}", memory.str());
+  std::memset(p, 0xFF, size);
+  EXPECT_EQ(0xFF, p[size / 2]);
+
+  // re-allocating releases the previous memory
+  p = static_cast<uint8_t*>(memory.allocate(size / 2, false, false));
+  ASSERT_NE(nullptr, p);
+  EXPECT_FALSE(memory.isInterleaved());
+}
+
+TEST_F(LargeMemoryTest, mapFile) {
+  const std::string path = "./large_memory_test.bin";
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    for (int i = 0; i < 8192; ++i) file.put(static_cast<char>(i % 251));
+  }
+  LargeMemory memory;
+  auto* p = static_cast<uint8_t*>(memory.mapFile(path, 8192));
+  ASSERT_NE(nullptr, p);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % LargeMemory::ALIGNMENT);
+  EXPECT_EQ(100, p[100]);
+  EXPECT_EQ(8191 % 251, p[8191]);
+
+  // mapping is private - changes are not written to the file
+  p[100] = 0;
+  memory.release();
+  p = static_cast<uint8_t*>(memory.mapFile(path, 4096));
+  ASSERT_NE(nullptr, p);
+  EXPECT_EQ(100, p[100]);
+
+  // file too small or missing
+  EXPECT_EQ(nullptr, memory.mapFile(path, 16384));
+  EXPECT_EQ(nullptr, memory.mapFile("./not_existing.bin", 4096));
+  std::remove(path.c_str());
+}
+
+TEST_F(LargeMemoryTest, swap) {
+  LargeMemory memory;
+  LargeMemory other;
+  auto* p = static_cast<uint8_t*>(memory.allocate(1024 * 1024, false, false));
+  ASSERT_NE(nullptr, p);
+  p[0] = 42;
+  const std::size_t pageSize = memory.getPageSize();
+
+  memory.swap(other);
+  EXPECT_EQ("no memory", memory.str());
+  EXPECT_EQ(0, memory.getPageSize());
+  EXPECT_EQ(pageSize, other.getPageSize());
+  EXPECT_EQ(42, p[0]);
+
+  // the swapped block is released by its new owner
+  other.release();
+  EXPECT_EQ("no memory", other.str());
+}
@@ -0,0 +1,114 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "common/Logging.h"
+#include "init.h"
+#include "types/types.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "spdlog/sinks/base_sink.h"
+
+#include <gtest/gtest.h>
+using testing::Eq;
+
+class LoggingTest : public ::testing::Test {
+public:
+  static void SetUpTestSuite() {
+    NEWLINE;
+    init::init();
+    NEWLINE;
+    Logger::get().TEST_LOG->set_level(spdlog::level::warn);
+  }
+
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+namespace {
+  int evaluations = 0;
+  std::string expensive() {
+    evaluations++;
+    return "expensive";
+  }
+
+  // counts the messages written by the logger's background thread
+  class CountingSink : public spdlog::sinks::base_sink<std::mutex> {
+  public:
+    int count() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return messages;
+    }
+
+  protected:
+    void sink_it_(const spdlog::details::log_msg&) override { messages++; }
+    void flush_() override {}
+
+  private:
+    int messages = 0;
+  };
+}// namespace
+
+// arguments of disabled log levels must not be evaluated
+TEST_F(LoggingTest, lazyArguments) {
+  evaluations = 0;
+  LOG__TRACE(Logger::get().TEST_LOG, "Trace {}", expensive());
+  LOG__DEBUG(Logger::get().TEST_LOG, "Debug {}", expensive());
+  LOG__INFO(Logger::get().TEST_LOG, "Info {}", expensive());
+  EXPECT_EQ(0, evaluations);
+
+  LOG__WARN(Logger::get().TEST_LOG, "Warn {}", expensive());
+  EXPECT_EQ(1, evaluations);
+
+  // levels above LOG__LEVEL are compiled out and never evaluated
+  Logger::get().TEST_LOG->set_level(spdlog::level::trace);
+  evaluations = 0;
+  LOG__INFO(Logger::get().TEST_LOG, "Info {}", expensive());
+  LOG__DEBUG(Logger::get().TEST_LOG, "Debug {}", expensive());
+  EXPECT_EQ(LOG__LEVEL > INFO__LVL ? 2 : 1, evaluations);
+  Logger::get().TEST_LOG->set_level(spdlog::level::warn);
+}
+
+// async loggers hand messages to a background thread which writes them
+TEST_F(LoggingTest, asyncLogger) {
+  const auto logger = Logger::createLogger("Async_Test_Logger", true);
+  ASSERT_NE(nullptr, std::dynamic_pointer_cast<spdlog::async_logger>(logger));
+  EXPECT_EQ(nullptr, std::dynamic_pointer_cast<spdlog::async_logger>(Logger::createLogger("Sync_Test_Logger", false)));
+
+  const auto sink = std::make_shared<CountingSink>();
+  logger->sinks().clear();
+  logger->sinks().push_back(sink);
+  logger->set_level(spdlog::level::info);
+
+  for (int i = 0; i < 100; i++) {
+    LOG__INFO(logger, "Async {}", i);
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (sink->count() < 100 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(100, sink->count());
+
+  spdlog::drop("Async_Test_Logger");
+  spdlog::drop("Sync_Test_Logger");
+}
@@ -0,0 +1,91 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#include <atomic>
+
+#include "init.h"
+#include "types/types.h"
+#include "common/Logging.h"
+#include "common/Worker.h"
+#include "AllocationCounter.h"
+
+#include <gtest/gtest.h>
+using testing::Eq;
+
+class WorkerTest : public ::testing::Test {
+public:
+  static void SetUpTestSuite() {
+    NEWLINE;
+    init::init();
+    NEWLINE;
+    Logger::get().TEST_LOG->set_level(spdlog::level::debug);
+  }
+
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(WorkerTest, runsJobOnEachStart) {
+  std::atomic<int> runs{0};
+  Worker worker([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    runs++;
+  });
+  EXPECT_EQ(0, runs);
+
+  for (int i = 1; i <= 10; i++) {
+    worker.start();
+    worker.wait();
+    EXPECT_EQ(i, runs);
+  }
+
+  // a start while the job is still running waits for the previous run
+  worker.start();
+  worker.start();
+  worker.wait();
+  EXPECT_EQ(12, runs);
+}
+
+TEST_F(WorkerTest, finishesStartedJobOnDestruction) {
+  std::atomic<int> runs{0};
+  {
+    Worker worker([&] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      runs++;
+    });
+    worker.start();
+  }
+  EXPECT_EQ(1, runs);
+}
+
+TEST_F(WorkerTest, noAllocations) {
+  std::atomic<int> runs{0};
+  Worker worker([&] { runs++; });
+  uint64_t allocations;
+  {
+    AllocationCounter counter{};
+    for (int i = 0; i < 100; i++) {
+      worker.start();
+      worker.wait();
+    }
+    allocations = counter.allocations();
+  }
+  EXPECT_EQ(100, runs);
+  EXPECT_EQ(0, allocations);
+}
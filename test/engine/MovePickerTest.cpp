@@ -0,0 +1,170 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <algorithm>
+#include <set>
+
+#include "init.h"
+#include "types/types.h"
+#include "common/Logging.h"
+#include "chesscore/History.h"
+#include "chesscore/MoveGenerator.h"
+#include "chesscore/Position.h"
+#include "engine/MovePicker.h"
+
+#include <gtest/gtest.h>
+using testing::Eq;
+
+class MovePickerTest : public ::testing::Test {
+public:
+  static void SetUpTestSuite() {
+    NEWLINE;
+    init::init();
+    NEWLINE;
+    Logger::get().TEST_LOG->set_level(spdlog::level::debug);
+  }
+
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+
+  // all moves of the picker - fails on duplicates
+  static MoveList pickAll(MovePicker& picker) {
+    MoveList moves{};
+    Move move;
+    while ((move = picker.next()) != MOVE_NONE) {
+      EXPECT_EQ(moves.end(), std::find(moves.begin(), moves.end(), move)) << "duplicate move " << str(move);
+      moves.push_back(move);
+    }
+    return moves;
+  }
+
+  static std::set<Move> asSet(const MoveList& moves) {
+    std::set<Move> set{};
+    for (Move m : moves) set.insert(moveOf(m));
+    return set;
+  }
+};
+
+// The picker returns exactly the moves of the pseudo legal move generator
+// no matter which tt, killer or counter moves are given.
+TEST_F(MovePickerTest, allMoves) {
+  const std::string fens[] = {
+    START_POSITION_FEN,
+    "r3k2r/1ppn3p/2q1q1n1/4P3/2q1Pp2/B5R1/pbp2PPP/1R4K1 b kq e3",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+    "r3k2r/1ppn3p/2q1q1n1/4P3/2q1Pp2/6R1/pbp2PPP/1R4K1 w kq -",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5Q2/PPPP1PPP/RNB1K1NR w KQkq -"};
+  MoveGenerator mg{};
+  History history{};
+  for (const std::string& fen : fens) {
+    Position position(fen);
+    const bool hasCheck   = position.hasCheck();
+    const MoveList all    = *mg.generatePseudoLegalMoves(position, GenAll, hasCheck);
+    const MoveList nonQ   = *mg.generatePseudoLegalMoves(position, GenNonQuiet, hasCheck);
+    const Move none[2]    = {MOVE_NONE, MOVE_NONE};
+    const Move illegal    = createMove(SQ_A3, SQ_H5);// not pseudo legal in any of the positions
+    const Move killers[2] = {all.at(all.size() - 1), illegal};
+    for (std::size_t i = 0; i < all.size(); i += 5) {
+      history.historyCount[position.getNextPlayer()][fromSquare(all[i])][toSquare(all[i])] += 10'000 * i;
+    }
+
+    MovePicker plain(position, GenAll, hasCheck, MOVE_NONE, none, MOVE_NONE, nullptr);
+    EXPECT_EQ(asSet(all), asSet(pickAll(plain))) << fen;
+
+    MovePicker withTt(position, GenAll, hasCheck, moveOf(all.at(all.size() / 2)), killers, moveOf(all.at(1)), &history);
+    const MoveList picked = pickAll(withTt);
+    EXPECT_EQ(all.size(), picked.size()) << fen;
+    EXPECT_EQ(asSet(all), asSet(picked)) << fen;
+    EXPECT_EQ(moveOf(all.at(all.size() / 2)), picked.at(0)) << fen;
+
+    MovePicker captures(position, GenNonQuiet, hasCheck, illegal, killers, MOVE_NONE, &history);
+    EXPECT_EQ(asSet(nonQ), asSet(pickAll(captures))) << fen;
+  }
+}
+
+// A legal move picker returns exactly the legal moves.
+TEST_F(MovePickerTest, legalMoves) {
+  const std::string fens[] = {
+    START_POSITION_FEN,
+    "r3k2r/1ppn3p/2q1qNn1/8/2q1Pp2/B5R1/p1p2PPP/1R4K1 b kq e3",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+    "8/8/3p4/KPp4r/1R3p1k/8/4P1P1/8 w - c6",
+    "4k3/4q3/8/8/1b2P3/8/3N4/4KBNr w - -",
+    "4k3/8/8/8/1b6/8/3N4/r3K3 w - -"};
+  MoveGenerator mg{};
+  for (const std::string& fen : fens) {
+    Position position(fen);
+    const bool hasCheck = position.hasCheck();
+    const MoveList all  = *mg.generatePseudoLegalMoves(position, GenAll, hasCheck);
+    const MoveList legal = *mg.generateLegalMoves(position, GenAll);
+    // all pseudo legal moves as tt, killer and counter moves - even if not evasions
+    const MoveList pseudo = *mg.generatePseudoLegalMoves(position, GenAll, false);
+    const Move killers[2] = {pseudo.at(pseudo.size() - 1), pseudo.at(pseudo.size() - 2)};
+    for (Move ttMove : pseudo) {
+      MovePicker picker(position, GenAll, hasCheck, ttMove, killers, pseudo.at(0), nullptr, true);
+      EXPECT_TRUE(picker.isLegalOnly());
+      EXPECT_EQ(asSet(legal), asSet(pickAll(picker))) << fen << " " << str(ttMove);
+    }
+    EXPECT_LE(legal.size(), all.size());
+  }
+}
+
+TEST_F(MovePickerTest, stages) {
+  // Qxd5 loses the queen, exd5 wins a knight, a3 and h3 are quiet
+  Position position("4k3/8/4p3/2pn4/4P3/8/P2Q3P/4K3 w - -");
+  const Move ttMove     = createMove(SQ_H2, SQ_H3);
+  const Move killers[2] = {createMove(SQ_A2, SQ_A3), createMove(SQ_A2, SQ_A4)};
+  const Move counter    = createMove(SQ_E1, SQ_F1);
+  MovePicker picker(position, GenAll, false, ttMove, killers, counter, nullptr);
+
+  EXPECT_EQ(ttMove, picker.next());
+  EXPECT_EQ(MovePicker::GEN_CAPTURES, picker.getStage());
+  // good capture
+  EXPECT_EQ(createMove(SQ_E4, SQ_D5), picker.next());
+  EXPECT_EQ(MovePicker::GOOD_CAPTURES, picker.getStage());
+  // killers and counter move before all other quiet moves
+  EXPECT_EQ(killers[0], picker.next());
+  EXPECT_EQ(killers[1], picker.next());
+  EXPECT_EQ(counter, picker.next());
+  // quiet moves are generated only now
+  EXPECT_EQ(MovePicker::GEN_QUIETS, picker.getStage());
+  Move move;
+  Move last = MOVE_NONE;
+  while ((move = picker.next()) != MOVE_NONE && picker.getStage() == MovePicker::QUIETS) {
+    EXPECT_FALSE(position.isCapturingMove(move));
+    EXPECT_NE(ttMove, move);
+    EXPECT_NE(killers[0], move);
+    EXPECT_NE(killers[1], move);
+    EXPECT_NE(counter, move);
+    last = move;
+  }
+  EXPECT_NE(MOVE_NONE, last);
+  // the losing capture is searched last
+  EXPECT_EQ(createMove(SQ_D2, SQ_D5), move);
+  EXPECT_EQ(MOVE_NONE, picker.next());
+  EXPECT_EQ(MovePicker::END, picker.getStage());
+
+  // captures only - quiet tt moves and killers are not returned
+  MovePicker qpicker(position, GenNonQuiet, false, ttMove, killers, counter, nullptr);
+  EXPECT_EQ(createMove(SQ_E4, SQ_D5), qpicker.next());
+  EXPECT_EQ(createMove(SQ_D2, SQ_D5), qpicker.next());
+  EXPECT_EQ(MOVE_NONE, qpicker.next());
+}
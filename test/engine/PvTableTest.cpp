@@ -0,0 +1,94 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "init.h"
+#include "types/types.h"
+#include "common/Logging.h"
+#include "engine/PvTable.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+using testing::Eq;
+
+class PvTableTest : public ::testing::Test {
+public:
+  static void SetUpTestSuite() {
+    NEWLINE;
+    init::init();
+    NEWLINE;
+    Logger::get().TEST_LOG->set_level(spdlog::level::debug);
+  }
+
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(PvTableTest, save) {
+  auto pv = std::make_unique<PvTable>();
+  const Move e2e4 = createMove(SQ_E2, SQ_E4, NORMAL);
+  const Move e7e5 = createMove(SQ_E7, SQ_E5, NORMAL);
+  const Move g1f3 = createMove(SQ_G1, SQ_F3, NORMAL);
+
+  // leaf node at ply 3 has no pv
+  pv->clear(3);
+  pv->save(2, g1f3);
+  pv->save(1, e7e5);
+  pv->save(0, e2e4);
+  EXPECT_EQ(1, pv->size(2));
+  EXPECT_EQ(2, pv->size(1));
+  EXPECT_EQ(3, pv->size(0));
+  EXPECT_EQ(e2e4, pv->at(0, 0));
+  EXPECT_EQ(e7e5, pv->at(0, 1));
+  EXPECT_EQ(g1f3, pv->at(0, 2));
+  EXPECT_EQ(MoveList({e2e4, e7e5, g1f3}), pv->line(0));
+  fprintln("PV: {}", str(pv->line(0)));
+
+  // a new best move at ply 1 with a shorter pv replaces the old row
+  pv->clear(2);
+  pv->save(1, g1f3);
+  pv->save(0, e2e4);
+  EXPECT_EQ(MoveList({e2e4, g1f3}), pv->line(0));
+
+  pv->clearAll();
+  EXPECT_TRUE(pv->empty(0));
+  EXPECT_TRUE(pv->line(0).empty());
+}
+
+TEST_F(PvTableTest, capacity) {
+  auto pv = std::make_unique<PvTable>();
+  const Move e2e4 = createMove(SQ_E2, SQ_E4, NORMAL);
+  const Move e7e5 = createMove(SQ_E7, SQ_E5, NORMAL);
+
+  // fill all rows completely (one more than fits) - rows must not overlap
+  for (int ply = 0; ply < PvTable::SIZE; ++ply) {
+    pv->clear(ply);
+    for (int i = 0; i <= PvTable::capacity(ply); ++i) pv->push_back(ply, ply % 2 ? e7e5 : e2e4);
+    EXPECT_EQ(PvTable::capacity(ply), pv->size(ply));
+  }
+  for (int ply = 0; ply < PvTable::SIZE; ++ply) {
+    for (int i = 0; i < pv->size(ply); ++i) ASSERT_EQ(ply % 2 ? e7e5 : e2e4, pv->at(ply, i));
+  }
+
+  // a full child row still fits into the parent row
+  pv->save(0, e2e4);
+  EXPECT_EQ(PvTable::SIZE, pv->size(0));
+  EXPECT_EQ(e2e4, pv->at(0, 0));
+  EXPECT_EQ(e7e5, pv->at(0, PvTable::SIZE - 1));
+}
@@ -17,13 +17,20 @@
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+#include "AllocationCounter.h"
 #include "engine/Search.h"
 #include "engine/SearchConfig.h"
 #include "init.h"
 #include "types/types.h"
 
+#include <algorithm>
+#include <sstream>
+#include <streambuf>
+#include <string_view>
+#include <thread>
 #include <engine/EvalConfig.h>
 #include <gtest/gtest.h>
+#include <vector>
 using testing::Eq;
 
 class SearchTest : public ::testing::Test {
@@ -108,11 +115,40 @@ TEST_F(SearchTest, startTimer) {
   s.timeLimit                = 2s;
   s.extraTime                = 1s;
   s.startTimer();
-  s.timerThread.join();
+  s.timerWorker->wait();
   EXPECT_LT(3s, (high_resolution_clock::now() - s.startTime));
   EXPECT_GT(3.020s, (high_resolution_clock::now() - s.startTime));
 }
 
+// extra time added while the timer is waiting moves the deadline
+TEST_F(SearchTest, timerReArm) {
+  Search s{};
+  s.searchLimits.timeControl = true;
+  s.startTime                = high_resolution_clock::now();
+  s.timeLimit                = 200ms;
+  s.extraTime                = 0ms;
+  s.startTimer();
+  SLEEP(50ms);
+  s.addExtraTime(2.0);
+  EXPECT_EQ(200ms, s.extraTime);
+  s.timerWorker->wait();
+  EXPECT_TRUE(s.stopSearchFlag);
+  EXPECT_LE(400ms, (high_resolution_clock::now() - s.startTime));
+  EXPECT_GT(450ms, (high_resolution_clock::now() - s.startTime));
+
+  // a stop wakes up the timer before its deadline
+  s.stopSearchFlag = false;
+  s.startTime      = high_resolution_clock::now();
+  s.timeLimit      = 10s;
+  s.extraTime      = 0ms;
+  s.startTimer();
+  SLEEP(20ms);
+  s.stopSearchFlag = true;
+  s.notifyTimer();
+  s.timerWorker->wait();
+  EXPECT_GT(1s, (high_resolution_clock::now() - s.startTime));
+}
+
 TEST_F(SearchTest, startStopSearch) {
   SearchConfig::USE_BOOK = false;
   Position p{};
@@ -130,6 +166,25 @@ TEST_F(SearchTest, startStopSearch) {
   EXPECT_LT(1s, s.getLastSearchResult().time);
 }
 
+// many short searches in a row re-use the persistent worker threads
+TEST_F(SearchTest, repeatedSearches) {
+  SearchConfig::USE_BOOK = false;
+  Position p{};
+  SearchLimits sl{};
+  Search s{};
+  sl.depth = 4;
+  s.isReady();
+  for (int i = 0; i < 20; ++i) {
+    s.startSearch(p, sl);
+    s.waitWhileSearching();
+    ASSERT_TRUE(s.hasResult());
+    EXPECT_NE(MOVE_NONE, s.getLastSearchResult().bestMove);
+  }
+  // a stop while not searching must not block
+  s.stopSearch();
+  EXPECT_FALSE(s.isSearching());
+}
+
 TEST_F(SearchTest, startTimedSearch) {
   SearchConfig::USE_BOOK = false;
   Position p{};
@@ -147,6 +202,42 @@ TEST_F(SearchTest, startTimedSearch) {
   EXPECT_GT(1s * 1.1, s.getLastSearchResult().time);
 }
 
+// Stop latency of time controlled searches. Runs many very short searches
+// which must run until their deadline and are then stopped by the timer or
+// the deadline check in the search. The overrun after the deadline depends
+// on the machine and its load - only the median is checked against the
+// 1 ms stop latency target, the 99th percentile and max are printed.
+TEST_F(SearchTest, timeOverrun) {
+  SearchConfig::USE_BOOK = false;
+  Logger::get().SEARCH_LOG->set_level(spdlog::level::warn);
+  Position p{};
+  SearchLimits sl{};
+  Search s{};
+  sl.timeControl = true;
+  sl.moveTime    = 5ms;
+  s.isReady();
+
+  const int searches = 1'000;
+  std::vector<nanoseconds> overruns{};
+  overruns.reserve(searches);
+  for (int i = 0; i < searches; ++i) {
+    s.startSearch(p, sl);
+    s.waitWhileSearching();
+    EXPECT_TRUE(s.stopSearchFlag);
+    EXPECT_TRUE(s.hasResult());
+    EXPECT_LE(nanoseconds(sl.moveTime), s.getLastSearchResult().time);
+    overruns.push_back(s.getLastSearchResult().time - sl.moveTime);
+  }
+  Logger::get().SEARCH_LOG->set_level(spdlog::level::debug);
+
+  std::sort(overruns.begin(), overruns.end());
+  const nanoseconds median = overruns[searches / 2];
+  const nanoseconds p99    = overruns[searches * 99 / 100];
+  const nanoseconds max    = overruns.back();
+  fprintln("Time overrun of {} searches: median {} 99% {} max {}", searches, str(median), str(p99), str(max));
+  EXPECT_GT(nanoseconds(1ms), median);
+}
+
 TEST_F(SearchTest, bookMoveSearch) {
   SearchConfig::USE_BOOK = true;
   Position p{};
@@ -220,6 +311,59 @@ TEST_F(SearchTest, depthLimitedSearch) {
   EXPECT_EQ(depth, s.getLastSearchResult().depth);
 }
 
+TEST_F(SearchTest, lazySmpSearch) {
+  SearchConfig::USE_BOOK = false;
+  SearchConfig::THREADS  = 4;
+  Position p{};
+  SearchLimits sl{};
+  Search s{};
+  const int depth = 8;
+  sl.depth        = depth;
+  s.isReady();
+  s.startSearch(p, sl);
+  EXPECT_TRUE(s.isSearching());
+  s.waitWhileSearching();
+  EXPECT_TRUE(s.hasResult());
+  EXPECT_EQ(depth, s.getLastSearchResult().depth);
+  EXPECT_NE(MOVE_NONE, s.getLastSearchResult().bestMove);
+  SearchConfig::THREADS = 1;
+}
+
+// the node limit applies to the nodes searched by all threads together
+TEST_F(SearchTest, lazySmpNodeLimit) {
+  SearchConfig::USE_BOOK = false;
+  SearchConfig::THREADS  = 4;
+  Position p{};
+  SearchLimits sl{};
+  Search s{};
+  sl.nodes = 3'000'000;
+  s.isReady();
+  s.startSearch(p, sl);
+  s.waitWhileSearching();
+  EXPECT_TRUE(s.hasResult());
+  LOG__INFO(Logger::get().TEST_LOG, "Node limit {:L} nodes searched {:L}", sl.nodes, s.getLastSearchResult().nodes);
+  EXPECT_LE(sl.nodes, s.getLastSearchResult().nodes);
+  EXPECT_GT(sl.nodes * 102 / 100, s.getLastSearchResult().nodes);
+  SearchConfig::THREADS = 1;
+}
+
+TEST_F(SearchTest, lazySmpMate3Search) {
+  SearchConfig::USE_BOOK = false;
+  SearchConfig::THREADS  = 4;
+  Position p{"8/8/8/8/8/4K3/R7/6k1 w - - 0 6"};
+  SearchLimits sl{};
+  Search s{};
+  sl.timeControl = true;
+  sl.moveTime    = 60s;
+  sl.mate        = 3;
+  s.isReady();
+  s.startSearch(p, sl);
+  s.waitWhileSearching();
+  EXPECT_EQ(VALUE_CHECKMATE - 5, s.getLastSearchResult().bestMoveValue);
+  EXPECT_TRUE(s.getLastSearchResult().mateFound);
+  SearchConfig::THREADS = 1;
+}
+
 TEST_F(SearchTest, stalemate0Search) {
   SearchConfig::USE_BOOK = false;
   Position p{"6R1/8/8/8/8/5K2/R7/7k b - -"};
@@ -323,6 +467,80 @@ TEST_F(SearchTest, mate5Search) {
   EXPECT_TRUE(s.getLastSearchResult().mateFound);
 }
 
+namespace {
+  // output stream buffer which discards everything - other than a string
+  // stream it never allocates memory. Counts the periodic search updates.
+  class NullBuffer : public std::streambuf {
+  public:
+    int searchUpdates = 0;
+
+  protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+      if (std::string_view(s, static_cast<std::size_t>(n)).find("currmove") != std::string_view::npos) searchUpdates++;
+      return n;
+    }
+  };
+}// namespace
+
+// The search must not allocate memory. After a warm-up search which
+// initializes all search data the same position is searched again with
+// a UciHandler attached while counting all allocations. This includes the
+// iterative deepening, aspiration windows, iteration end handling and the
+// uci output.
+TEST_F(SearchTest, zeroAllocations) {
+  // check the allocation counter itself
+  {
+    AllocationCounter counter{};
+    auto p = std::make_unique<int>(1);
+    EXPECT_EQ(1, counter.allocations());
+  }
+
+  SearchConfig::USE_BOOK = false;
+  Logger::get().SEARCH_LOG->set_level(spdlog::level::warn);
+  NullBuffer nullBuffer;
+  std::ostream os(&nullBuffer);
+  std::istringstream is("isready");
+  UciHandler uciHandler(&is, &os);
+  uciHandler.loop();
+  Search& search = *uciHandler.getSearchPtr();
+
+  Position position("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -");
+  SearchLimits searchLimits{};
+  searchLimits.timeControl = true;
+  searchLimits.moveTime    = milliseconds{200};
+
+  // warm-up
+  search.startSearch(position, searchLimits);
+  search.waitWhileSearching();
+
+  // infinite search stopped after a while so the periodic search update
+  // (every second) is sent while the iterations take long enough
+  SearchConfig::UCI_SHOW_CURR_LINE = true;
+  searchLimits.timeControl         = false;
+  searchLimits.infinite            = true;
+
+  // the arguments are copied before counting as startSearch takes them by value
+  search.clearTT();
+  Position searchPosition         = position;
+  SearchLimits searchSearchLimits = searchLimits;
+  uint64_t allocations;
+  {
+    AllocationCounter counter{};
+    search.startSearch(std::move(searchPosition), std::move(searchSearchLimits));
+    std::this_thread::sleep_for(seconds{4});
+    search.stopSearch();
+    allocations = counter.allocations();
+  }
+  Logger::get().SEARCH_LOG->set_level(spdlog::level::debug);
+  SearchConfig::UCI_SHOW_CURR_LINE = false;
+
+  fprintln("Nodes: {:L} Search updates: {} Allocations: {:L}", search.getLastSearchResult().nodes, nullBuffer.searchUpdates, allocations);
+  EXPECT_GT(search.getLastSearchResult().nodes, 0);
+  EXPECT_GT(nullBuffer.searchUpdates, 0);
+  EXPECT_EQ(0, allocations);
+}
+
 TEST_F(SearchTest, quiescenceTest) {
 
   Search search;
@@ -17,9 +17,15 @@
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <random>
+#include <thread>
+#include <vector>
 
 #include "common/Logging.h"
+#include "engine/SearchConfig.h"
 #include "engine/TT.h"
 #include "init.h"
 
@@ -149,6 +155,24 @@ TEST_F(TT_Test, zero) {
   LOG__INFO(Logger::get().TEST_LOG, "Number of entries:         {:L}", tt.getNumberOfEntries());
 }
 
+TEST_F(TT_Test, largePages) {
+  SearchConfig::USE_LARGE_PAGES = true;
+  TT tt(64);
+  LOG__INFO(Logger::get().TEST_LOG, "{}", tt.str());
+  EXPECT_GE(tt.getPageSize(), 4096);
+  EXPECT_NE(std::string::npos, tt.str().find("pages"));
+
+  // no large pages - uses the default page size
+  SearchConfig::USE_LARGE_PAGES = false;
+  tt.resize(64);
+  LOG__INFO(Logger::get().TEST_LOG, "{}", tt.str());
+  EXPECT_GE(tt.getPageSize(), 4096);
+  EXPECT_EQ(0, tt.getNumberOfEntries());
+  tt.put(1234567ULL, Depth(5), createMove(SQ_E2, SQ_E4), Value(100), EXACT, Value(50));
+  EXPECT_TRUE(tt.getMatch(1234567ULL));
+  SearchConfig::USE_LARGE_PAGES = true;
+}
+
 TEST_F(TT_Test, parallelClear) {
   const int sizeInMB = 4'096;
   LOG__INFO(Logger::get().TEST_LOG, "Trying to create a TT with {:L} MB in size", sizeInMB);
@@ -173,7 +197,7 @@ TEST_F(TT_Test, put) {
 
   const Key key1 = randomKey(rg);
   const Key key2 = key1 + 13;               // different bucket
-  const Key key3 = key1 + collisionDistance;// same bucket - collision
+  const Key key3 = key1 + collisionDistance;// same bucket - second entry in cluster
 
   // new entry in empty bucket at pos 0
   tt.put(key1, Depth(6), createMove(SQ_E2, SQ_E4), Value(101), EXACT, Value(1001));
@@ -199,18 +223,265 @@ TEST_F(TT_Test, put) {
   EXPECT_EQ(tt.getMatch(key2)->depth, Value(5));
 
 
-  // new entry (collision)
+  // new entry in same cluster (no collision)
   tt.put(key3, Depth(6), createMove(SQ_E2, SQ_E4), Value(103), EXACT, Value(1003));
   EXPECT_EQ(3, tt.getNumberOfPuts());
-  EXPECT_EQ(2, tt.getNumberOfEntries());
+  EXPECT_EQ(3, tt.getNumberOfEntries());
   EXPECT_EQ(0, tt.getNumberOfUpdates());
-  EXPECT_EQ(1, tt.getNumberOfCollisions());
-  EXPECT_EQ(1, tt.getNumberOfOverwrites());
+  EXPECT_EQ(0, tt.getNumberOfCollisions());
+  EXPECT_EQ(0, tt.getNumberOfOverwrites());
+  EXPECT_EQ(tt.getMatch(key1)->key, key1);
   EXPECT_EQ(tt.getMatch(key3)->key, key3);
   EXPECT_EQ(tt.getMatch(key3)->value, Value(103));
   EXPECT_EQ(tt.getMatch(key3)->eval, Value(1003));
 }
 
+TEST_F(TT_Test, cluster) {
+  std::random_device rd;
+  std::mt19937_64 rg(rd());
+  std::uniform_int_distribution<unsigned long long> randomKey;
+
+  TT tt(10);
+
+  // keys with this distance map to the same cluster
+  const uint64_t clusterDistance = tt.numberOfClusters;
+  const Key key                  = randomKey(rg);
+
+  // fill the cluster
+  const Depth depths[TT::CLUSTER_SIZE] = {Depth(5), Depth(3), Depth(7), Depth(6)};
+  for (std::size_t i = 0; i < TT::CLUSTER_SIZE; ++i) {
+    tt.put(key + i * clusterDistance, depths[i], createMove(SQ_E2, SQ_E4), Value(100 + i), EXACT, VALUE_NONE);
+  }
+  EXPECT_EQ(TT::CLUSTER_SIZE, tt.getNumberOfEntries());
+  EXPECT_EQ(0, tt.getNumberOfCollisions());
+  for (std::size_t i = 0; i < TT::CLUSTER_SIZE; ++i) {
+    EXPECT_TRUE(tt.getMatch(key + i * clusterDistance));
+  }
+
+  // cluster is full - the entry with the lowest depth is replaced
+  const Key newKey = key + TT::CLUSTER_SIZE * clusterDistance;
+  tt.put(newKey, Depth(4), createMove(SQ_E2, SQ_E4), Value(200), EXACT, VALUE_NONE);
+  EXPECT_EQ(1, tt.getNumberOfCollisions());
+  EXPECT_EQ(1, tt.getNumberOfOverwrites());
+  EXPECT_TRUE(tt.getMatch(newKey));
+  EXPECT_FALSE(tt.getMatch(key + 1 * clusterDistance));
+  EXPECT_TRUE(tt.getMatch(key + 0 * clusterDistance));
+  EXPECT_TRUE(tt.getMatch(key + 2 * clusterDistance));
+  EXPECT_TRUE(tt.getMatch(key + 3 * clusterDistance));
+
+  // aged entries are replaced before younger entries with higher depth
+  tt.newGeneration();
+  tt.newGeneration();
+  tt.probe(newKey);// probe marks the entry as used in this generation
+  tt.probe(key + 3 * clusterDistance);
+  const Key newKey2 = key + (TT::CLUSTER_SIZE + 1) * clusterDistance;
+  tt.put(newKey2, Depth(2), createMove(SQ_E2, SQ_E4), Value(201), EXACT, VALUE_NONE);
+  EXPECT_TRUE(tt.getMatch(newKey2));
+  EXPECT_FALSE(tt.getMatch(key + 0 * clusterDistance));
+  EXPECT_TRUE(tt.getMatch(newKey));
+  EXPECT_TRUE(tt.getMatch(key + 2 * clusterDistance));
+  EXPECT_TRUE(tt.getMatch(key + 3 * clusterDistance));
+}
+
+TEST_F(TT_Test, generation) {
+  TT tt(10);
+  const Key key = 123'456'789ULL;
+
+  tt.put(key, Depth(5), createMove(SQ_E2, SQ_E4), Value(100), EXACT, Value(50));
+  EXPECT_EQ(0, tt.getMatch(key)->age);
+
+  // a new generation ages all entries without touching them
+  tt.newGeneration();
+  tt.newGeneration();
+  EXPECT_EQ(2, tt.getMatch(key)->age);
+
+  // probing marks the entry as used in the current generation
+  EXPECT_EQ(0, tt.probe(key)->age);
+  EXPECT_EQ(0, tt.getMatch(key)->age);
+
+  // age is capped for entries not used for many generations
+  for (int i = 0; i < 10; ++i) tt.newGeneration();
+  EXPECT_EQ(TT::MAX_AGE, tt.getMatch(key)->age);
+
+  // generations wrap around
+  for (int i = 0; i <= TT::GENERATION_MASK; ++i) tt.newGeneration();
+  EXPECT_EQ(12, tt.getGeneration());
+
+  // updating an entry marks it as used
+  tt.put(key, Depth(6), MOVE_NONE, Value(101), EXACT, VALUE_NONE);
+  EXPECT_EQ(0, tt.getMatch(key)->age);
+  EXPECT_EQ(Value(101), tt.getMatch(key)->value);
+  EXPECT_EQ(Value(50), tt.getMatch(key)->eval);
+  EXPECT_EQ(Depth(6), tt.getMatch(key)->depth);
+}
+
+TEST_F(TT_Test, saveLoad) {
+  const std::string path = "./tt_test.hash";
+  TT tt(16);
+  for (Key key = 1; key <= 1'000; ++key) {
+    tt.put(key * 0x9E3779B97F4A7C15ULL, Depth(key % 64), createMove(SQ_E2, SQ_E4), Value(key % 1000), EXACT, Value(50));
+  }
+  tt.newGeneration();
+  ASSERT_TRUE(tt.save(path));
+
+  // loading takes over size, generation and all entries
+  TT loaded(2);
+  ASSERT_TRUE(loaded.load(path));
+  EXPECT_EQ(tt.getSizeInByte(), loaded.getSizeInByte());
+  EXPECT_EQ(tt.getMaxNumberOfEntries(), loaded.getMaxNumberOfEntries());
+  EXPECT_EQ(tt.getGeneration(), loaded.getGeneration());
+  LOG__INFO(Logger::get().TEST_LOG, "{}", loaded.str());
+  for (Key key = 1; key <= 1'000; ++key) {
+    const auto entry = loaded.getMatch(key * 0x9E3779B97F4A7C15ULL);
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(Value(key % 1000), entry->value);
+    EXPECT_EQ(Depth(key % 64), entry->depth);
+    EXPECT_EQ(1, entry->age);
+  }
+
+  // changes to a loaded TT are not written back to the file
+  loaded.clear();
+  EXPECT_FALSE(loaded.getMatch(1 * 0x9E3779B97F4A7C15ULL));
+  TT reloaded(2);
+  ASSERT_TRUE(reloaded.load(path));
+  EXPECT_TRUE(reloaded.getMatch(1 * 0x9E3779B97F4A7C15ULL));
+
+  // saving a loaded TT replaces the file it is mapped from
+  reloaded.put(2'000 * 0x9E3779B97F4A7C15ULL, Depth(5), createMove(SQ_E2, SQ_E4), Value(2000), EXACT, Value(50));
+  ASSERT_TRUE(reloaded.save(path));
+  EXPECT_TRUE(reloaded.getMatch(1 * 0x9E3779B97F4A7C15ULL));
+  ASSERT_TRUE(loaded.load(path));
+  EXPECT_TRUE(loaded.getMatch(2'000 * 0x9E3779B97F4A7C15ULL));
+
+  // invalid files leave the TT unchanged
+  EXPECT_FALSE(reloaded.load("./not_existing.hash"));
+  EXPECT_TRUE(reloaded.getMatch(1 * 0x9E3779B97F4A7C15ULL));
+  std::remove(path.c_str());
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << "not a tt file";
+  EXPECT_FALSE(reloaded.load(path));
+  EXPECT_TRUE(reloaded.getMatch(1 * 0x9E3779B97F4A7C15ULL));
+
+  // a valid header followed by a truncated table can't be mapped
+  ASSERT_TRUE(tt.save(path));
+  std::filesystem::resize_file(path, TT::FILE_HEADER_SIZE + 1024);
+  const uint64_t sizeInByte = reloaded.getSizeInByte();
+  EXPECT_FALSE(reloaded.load(path));
+  EXPECT_EQ(sizeInByte, reloaded.getSizeInByte());
+  EXPECT_TRUE(reloaded.getMatch(1 * 0x9E3779B97F4A7C15ULL));
+
+  std::remove(path.c_str());
+}
+
+TEST_F(TT_Test, compact) {
+  const std::string path = "./tt_test_compact.hash";
+  TT tt(10, true);
+  ASSERT_TRUE(tt.isCompact());
+  EXPECT_EQ(TT::COMPACT_ENTRY_SIZE, tt.getEntrySize());
+  EXPECT_EQ(6, TT::COMPACT_CLUSTER_SIZE);
+
+  // 50% more entries in the same memory
+  TT wide(10);
+  EXPECT_EQ(wide.getSizeInByte(), tt.getSizeInByte());
+  EXPECT_EQ(wide.getMaxNumberOfEntries() * 3 / 2, tt.getMaxNumberOfEntries());
+
+  // keys with this distance map to the same cluster and
+  // differ in the upper 16 bits used to verify an entry
+  const Key clusterDistance = 1ULL << 48;
+  const Key key             = 0x0000'1234'5678'9ABCULL;
+
+  // fill the cluster
+  for (std::size_t i = 0; i < TT::COMPACT_CLUSTER_SIZE; ++i) {
+    tt.put(key + i * clusterDistance, Depth(10 + i), createMove(SQ_E2, SQ_E4), Value(100 + i), EXACT, Value(50 + i));
+  }
+  EXPECT_EQ(TT::COMPACT_CLUSTER_SIZE, tt.getNumberOfEntries());
+  EXPECT_EQ(0, tt.getNumberOfCollisions());
+  for (std::size_t i = 0; i < TT::COMPACT_CLUSTER_SIZE; ++i) {
+    const auto entry = tt.getMatch(key + i * clusterDistance);
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(key + i * clusterDistance, entry->key);
+    EXPECT_EQ(createMove(SQ_E2, SQ_E4), static_cast<Move>(entry->move));
+    EXPECT_EQ(Value(100 + i), entry->value);
+    EXPECT_EQ(Value(50 + i), entry->eval);
+    EXPECT_EQ(Depth(10 + i), entry->depth);
+    EXPECT_EQ(EXACT, entry->type);
+  }
+
+  // update keeps the eval if none is given
+  tt.put(key, Depth(12), MOVE_NONE, Value(99), BETA, VALUE_NONE);
+  EXPECT_EQ(1, tt.getNumberOfUpdates());
+  EXPECT_EQ(Value(99), tt.getMatch(key)->value);
+  EXPECT_EQ(Value(50), tt.getMatch(key)->eval);
+  EXPECT_EQ(BETA, tt.getMatch(key)->type);
+  EXPECT_EQ(createMove(SQ_E2, SQ_E4), static_cast<Move>(tt.getMatch(key)->move));
+
+  // cluster is full - the entry with the lowest depth minus age is replaced
+  tt.newGeneration();
+  tt.newGeneration();
+  EXPECT_EQ(2, tt.getMatch(key + 1 * clusterDistance)->age);
+  for (std::size_t i = 0; i < TT::COMPACT_CLUSTER_SIZE; ++i) {
+    if (i != 2) tt.probe(key + i * clusterDistance);
+  }
+  EXPECT_EQ(0, tt.getMatch(key + 1 * clusterDistance)->age);
+  const Key newKey = key + TT::COMPACT_CLUSTER_SIZE * clusterDistance;
+  tt.put(newKey, Depth(4), createMove(SQ_D2, SQ_D4), Value(200), EXACT, VALUE_NONE);
+  EXPECT_EQ(1, tt.getNumberOfOverwrites());
+  EXPECT_TRUE(tt.getMatch(newKey));
+  EXPECT_FALSE(tt.getMatch(key + 2 * clusterDistance));
+
+  // only the upper 16 bits and the index bits of the key are verified
+  EXPECT_TRUE(tt.getMatch(key ^ (1ULL << 40)));
+  EXPECT_FALSE(tt.getMatch(key ^ (1ULL << 60)));
+
+  // save and load keep the entry format
+  ASSERT_TRUE(tt.save(path));
+  TT loaded(2);
+  ASSERT_TRUE(loaded.load(path));
+  EXPECT_TRUE(loaded.isCompact());
+  EXPECT_EQ(tt.getMaxNumberOfEntries(), loaded.getMaxNumberOfEntries());
+  EXPECT_EQ(Value(200), loaded.getMatch(newKey)->value);
+  EXPECT_EQ(Value(99), loaded.getMatch(key)->value);
+  std::remove(path.c_str());
+
+  // clear and resize keep the entry format
+  tt.clear();
+  EXPECT_FALSE(tt.getMatch(key));
+  tt.resize(4);
+  EXPECT_TRUE(tt.isCompact());
+  tt.put(key, Depth(5), createMove(SQ_E2, SQ_E4), Value(100), EXACT, VALUE_NONE);
+  EXPECT_TRUE(tt.getMatch(key));
+}
+
+TEST_F(TT_Test, hashFull) {
+  for (const bool compactEntries : {false, true}) {
+    TT tt(10, compactEntries);
+    EXPECT_EQ(0, tt.hashFull());
+
+    // fill all entries of the sampled clusters
+    const std::size_t sampledEntries = TT::HASHFULL_SAMPLE_CLUSTERS * tt.getClusterSize();
+    for (std::size_t c = 0; c < TT::HASHFULL_SAMPLE_CLUSTERS; ++c) {
+      for (std::size_t i = 0; i < tt.getClusterSize(); ++i) {
+        tt.put(c + (static_cast<Key>(i + 1) << 48), Depth(5), createMove(SQ_E2, SQ_E4), Value(100), EXACT, VALUE_NONE);
+      }
+    }
+    EXPECT_EQ(sampledEntries, tt.getNumberOfEntries());
+    EXPECT_EQ(1000, tt.hashFull());
+
+    // entries outside of the sample are not counted
+    tt.put(TT::HASHFULL_SAMPLE_CLUSTERS + 1, Depth(5), createMove(SQ_E2, SQ_E4), Value(100), EXACT, VALUE_NONE);
+    EXPECT_EQ(sampledEntries + 1, tt.getNumberOfEntries());
+    EXPECT_EQ(1000, tt.hashFull());
+
+    // only entries of the current generation are counted
+    tt.newGeneration();
+    EXPECT_EQ(0, tt.hashFull());
+    for (std::size_t c = 0; c < TT::HASHFULL_SAMPLE_CLUSTERS / 2; ++c) {
+      tt.probe(c + (1ULL << 48));
+    }
+    EXPECT_EQ(500 / tt.getClusterSize(), tt.hashFull());
+    EXPECT_EQ(sampledEntries + 1, tt.getNumberOfEntries());
+  }
+}
+
 TEST_F(TT_Test, get) {
   std::random_device rd;
   std::mt19937_64 rg(rd());
@@ -227,21 +498,69 @@ TEST_F(TT_Test, get) {
 
   // new entry in empty slot
   tt.put(key1, Depth(6), createMove(SQ_E2, SQ_E4), Value(101), EXACT, Value(1001));
-  const TT::Entry* e1 = tt.getMatch(key1);
+  const auto e1 = tt.getMatch(key1);
   EXPECT_EQ(101, e1->value);
 
   // new entry in empty slot
   tt.put(key2, Depth(5), createMove(SQ_E2, SQ_E4), Value(102), EXACT, Value(1002));
-  const TT::Entry* e2 = tt.getMatch(key2);
+  const auto e2 = tt.getMatch(key2);
   EXPECT_EQ(102, e2->value);
 
   // new entry in occupied slot
   tt.put(key3, Depth(7), createMove(SQ_E2, SQ_E4), Value(103), EXACT, Value(1003));
-  const TT::Entry* e3 = tt.getMatch(key3);
+  const auto e3 = tt.getMatch(key3);
   EXPECT_EQ(103, e3->value);
 
-  const TT::Entry* e4 = tt.getMatch(key4);// not in TT
-  EXPECT_EQ(nullptr, e4);
+  const auto e4 = tt.getMatch(key4);// not in TT
+  EXPECT_FALSE(e4);
+}
+
+// Several threads write and read the same small TT concurrently. Every
+// entry written has a value, eval and move derived from its key. Any
+// entry returned by the TT must therefore be consistent with its key
+// - torn entries must never be returned.
+TEST_F(TT_Test, parallelPutProbe) {
+  TT tt(1);
+
+  const int noOfThreads = 4;
+  const int iterations  = 2'000'000;
+
+  std::atomic<uint64_t> inconsistent{0};
+  std::atomic<uint64_t> hits{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < noOfThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937_64 rg(t);
+      std::uniform_int_distribution<unsigned long long> randomKey(1, 100'000);
+      for (int i = 0; i < iterations; ++i) {
+        // keys are spread over the whole 64-bit range
+        const Key key    = randomKey(rg) * 0x9E3779B97F4A7C15ULL;
+        const auto value = static_cast<Value>(key % 1000);
+        const auto eval  = static_cast<Value>((key >> 16) % 1000);
+        const auto depth = static_cast<Depth>((key >> 32) % 100);
+        const Move move  = createMove(static_cast<Square>(key % 64), static_cast<Square>((key >> 8) % 64));
+        if (i % 2) {
+          tt.put(key, depth, move, value, EXACT, eval);
+        }
+        else {
+          const auto entry = tt.probe(key);
+          if (entry) {
+            hits++;
+            if (entry->value != value || entry->eval != eval || entry->move != static_cast<uint16_t>(move)) {
+              inconsistent++;
+            }
+          }
+        }
+      }
+    });
+  }
+  for (std::thread& th : threads) th.join();
+
+  LOG__INFO(Logger::get().TEST_LOG, "TT: {}", tt.str());
+  EXPECT_GT(hits, 0);
+  EXPECT_EQ(0, inconsistent);
+  EXPECT_EQ(noOfThreads * iterations / 2, tt.getNumberOfPuts());
+  EXPECT_EQ(noOfThreads * iterations / 2, tt.getNumberOfProbes());
 }
 
 // 17.6.2020 (loaner laptop)
@@ -119,6 +119,77 @@ TEST_F(UCITest, resizeHashTest) {
   EXPECT_TRUE(result.find("Resized hash") != string::npos);
 }
 
+TEST_F(UCITest, saveLoadHashTest) {
+  SearchConfig::USE_TT = true;
+  const string path = "./uci_test.hash";
+  ostringstream os;
+  string command = "isready\nsavehash " + path + "\nloadhash " + path + "\nloadhash ./not_existing.hash";
+  LOG__INFO(Logger::get().TEST_LOG, "COMMAND: " + command);
+  istringstream is(command);
+  UciHandler uciHandler(&is, &os);
+  uciHandler.loop();
+  string result = os.str();
+  LOG__DEBUG(Logger::get().TEST_LOG, "RESPONSE: \n" + result);
+  EXPECT_TRUE(result.find("Saved hash") != string::npos);
+  EXPECT_TRUE(result.find("Loaded hash") != string::npos);
+  EXPECT_TRUE(result.find("Could not load hash") != string::npos);
+  std::remove(path.c_str());
+}
+
+// ucinewgame must not clear a persistent hash just loaded from file
+TEST_F(UCITest, newGameKeepsPersistentHash) {
+  const string path           = "./uci_newgame_test.hash";
+  const string ttFile         = SearchConfig::TT_FILE;
+  const bool persistent       = SearchConfig::TT_PERSISTENT;
+  SearchConfig::USE_TT        = true;
+  SearchConfig::TT_FILE       = path;
+  SearchConfig::TT_PERSISTENT = false;
+  ostringstream os;
+  istringstream is("isready");
+  UciHandler uciHandler(&is, &os);
+  uciHandler.loop();
+
+  const auto& search = uciHandler.getSearchPtr();
+  const Key key      = Position().getZobristKey();
+  search->tt->put(key, Depth{5}, createMove(SQ_E2, SQ_E4), Value(100), EXACT, Value(50));
+  search->saveTT(path);
+  search->clearTT();
+  EXPECT_FALSE(search->tt->probe(key));
+  search->loadTT(path);
+  ASSERT_TRUE(search->isTTLoaded());
+
+  SearchConfig::TT_PERSISTENT = true;
+  istringstream newGame("ucinewgame");
+  uciHandler.loop(&newGame);
+  EXPECT_TRUE(search->tt->probe(key));
+
+  // after a search the next game clears the hash again
+  istringstream go("position startpos\ngo depth 2");
+  uciHandler.loop(&go);
+  search->waitWhileSearching();
+  EXPECT_FALSE(search->isTTLoaded());
+  istringstream secondGame("ucinewgame");
+  uciHandler.loop(&secondGame);
+  EXPECT_FALSE(search->tt->probe(key));
+
+  // without persistent hash a new game clears the hash - quit saved the
+  // cleared hash with persistent hash on so the file is written again
+  search->tt->put(key, Depth{5}, createMove(SQ_E2, SQ_E4), Value(100), EXACT, Value(50));
+  search->saveTT(path);
+  search->loadTT(path);
+  ASSERT_TRUE(search->isTTLoaded());
+  EXPECT_TRUE(search->tt->probe(key));
+  SearchConfig::TT_PERSISTENT = false;
+  istringstream newGameCleared("ucinewgame");
+  uciHandler.loop(&newGameCleared);
+  EXPECT_FALSE(search->tt->probe(key));
+  EXPECT_FALSE(search->isTTLoaded());
+
+  SearchConfig::TT_FILE       = ttFile;
+  SearchConfig::TT_PERSISTENT = persistent;
+  std::remove(path.c_str());
+}
+
 TEST_F(UCITest, positionTest) {
   ostringstream os;
   // normal
@@ -282,6 +353,45 @@ TEST_F(UCITest, testingBugs) {
   EXPECT_TRUE(os.str().find("Invalid move") == string::npos);
 }
 
+namespace {
+  // string buffer which counts how often the stream was flushed
+  class FlushCountingBuf : public std::stringbuf {
+  public:
+    int flushes = 0;
+
+  protected:
+    int sync() override {
+      flushes++;
+      return std::stringbuf::sync();
+    }
+  };
+}// namespace
+
+TEST_F(UCITest, outputFlush) {
+  FlushCountingBuf buf;
+  ostream os(&buf);
+  istringstream is("");
+  UciHandler uciHandler(&is, &os);
+
+  // an info batch is only flushed when it is complete
+  uciHandler.sendSearchUpdate(5, 8, 1'000'000, 2'000'000, milliseconds(500), 10);
+  uciHandler.sendCurrentRootMove(createMove(SQ_E2, SQ_E4), 3);
+  EXPECT_EQ(0, buf.flushes);
+  uciHandler.flush();
+  EXPECT_EQ(1, buf.flushes);
+
+  uciHandler.sendReadyOk();
+  EXPECT_EQ(2, buf.flushes);
+  uciHandler.sendResult(createMove(SQ_E2, SQ_E4), createMove(SQ_E7, SQ_E5));
+  EXPECT_EQ(3, buf.flushes);
+
+  EXPECT_EQ("info depth 5 seldepth 8 nodes 1000000 nps 2000000 time 500 hashfull 10\n"
+            "info currmove e2e4 currmovenumber 3\n"
+            "readyok\n"
+            "bestmove e2e4 ponder e7e5\n",
+            buf.str());
+}
+
 //
 //TEST_F(UCITest, goMateDepth) {
 //  ostringstream os;
@@ -532,7 +642,7 @@ TEST_F(UCITest, testingBugs) {
 //  EXPECT_EQ(PLY_MAX, engine.getSearchLimitsPtr()->getMaxDepth());
 //  EXPECT_EQ(15, engine.getSearchLimitsPtr()->getMoveTime());
 //  EXPECT_EQ(createMove("d2d4"), engine.getSearchLimitsPtr()->getMoves().front());
-//  EXPECT_EQ(createMove("e2e4"), engine.getSearchLimitsPtr()->getMoves().back());
+//  EXPECT_EQ(createMove(SQ_E2, SQ_E4), engine.getSearchLimitsPtr()->getMoves().back());
 //}
 //
 //TEST_F(UCITest, moveTest) {
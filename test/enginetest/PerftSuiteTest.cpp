@@ -0,0 +1,95 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "init.h"
+#include "common/Logging.h"
+#include "types/types.h"
+#include "version.h"
+#include "enginetest/PerftSuite.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+using testing::Eq;
+
+class PerftSuiteTest : public ::testing::Test {
+public:
+  static void SetUpTestSuite() {
+    NEWLINE;
+    init::init();
+    NEWLINE;
+  }
+
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(PerftSuiteTest, readFile) {
+  std::string filePath = FrankyCPP_PROJECT_ROOT;
+  filePath += "/test/testsets/perftsuite.epd";
+  PerftSuite ps{filePath, 4};
+  ASSERT_EQ(126, ps.testCases.size());
+  EXPECT_EQ("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -", ps.testCases[0].fen);
+  ASSERT_EQ(6, ps.testCases[0].expected.size());
+  EXPECT_EQ(20, ps.testCases[0].expected[0]);
+  EXPECT_EQ(119'060'324, ps.testCases[0].expected[5]);
+}
+
+TEST_F(PerftSuiteTest, invalidDepth) {
+  std::string filePath = FrankyCPP_PROJECT_ROOT;
+  filePath += "/test/testsets/perftsuite.epd";
+  EXPECT_THROW(PerftSuite(filePath, 0), std::invalid_argument);
+  EXPECT_THROW(PerftSuite(filePath, -1), std::invalid_argument);
+}
+
+TEST_F(PerftSuiteTest, runSuite) {
+  int depth = 4;
+#ifndef NDEBUG
+  depth = 3;
+#endif
+  std::string filePath = FrankyCPP_PROJECT_ROOT;
+  filePath += "/test/testsets/perftsuite.epd";
+  PerftSuite ps{filePath, depth};
+  EXPECT_TRUE(ps.runPerftSuite(2));
+  for (const auto& test : ps.getTestCases()) {
+    EXPECT_TRUE(test.success) << test.line;
+    EXPECT_EQ(depth, test.depth);
+  }
+}
+
+TEST_F(PerftSuiteTest, wrongCount) {
+  const std::string filePath = "perftsuite_test.epd";
+  {
+    std::ofstream file(filePath);
+    file << "4k3/8/8/8/8/8/8/4K2R w K - D1 15; D2 66; D3 1197;" << std::endl;
+    file << "4k3/8/8/8/8/8/8/R3K3 w Q - D1 16; D2 71; D3 1286;" << std::endl;
+    file << "no results in this line" << std::endl;
+  }
+  PerftSuite ps{filePath, 5};
+  EXPECT_FALSE(ps.runPerftSuite(1));
+  ASSERT_EQ(2, ps.getTestCases().size());
+  EXPECT_TRUE(ps.getTestCases()[0].success);
+  EXPECT_FALSE(ps.getTestCases()[1].success);
+  EXPECT_EQ(3, ps.getTestCases()[1].depth);
+  EXPECT_EQ(1287, ps.getTestCases()[1].nodes);
+  std::remove(filePath.c_str());
+}
@@ -69,3 +69,27 @@ TEST_F(SearchTreeSizeTest_Test, size_test) {
   SearchTreeSizeTest stst(DEPTH, MOVE_TIME, testFens);
   stst.start();
 }
+
+TEST_F(SearchTreeSizeTest_Test, thread_scaling) {
+  GTEST_SKIP();
+
+  static constexpr int DEPTH = 10;
+  static constexpr milliseconds MOVE_TIME{0};
+  static constexpr int START_FEN = 0;
+  static constexpr int END_FEN   = 15;
+
+  Logger::get().SEARCH_LOG->set_level(spdlog::level::warn);
+
+  // Prepare test fens
+  // get sub vector of fens to test
+  std::vector<std::string> allFens = Test_Fens::getFENs();
+  auto iterStart                   = allFens.begin() + START_FEN;
+  auto iterEnd                     = allFens.begin() + START_FEN + END_FEN;
+  if (iterEnd > allFens.end()) iterEnd = allFens.end();
+  if (iterStart > iterEnd) iterStart = iterEnd;
+  std::vector<std::string> testFens(iterStart, iterEnd);
+
+  // execute tests
+  SearchTreeSizeTest stst(DEPTH, MOVE_TIME, testFens);
+  stst.startThreadScaling();
+}
@@ -273,6 +273,38 @@ TEST(TypesTest, sortMoveListByValue) {
   EXPECT_EQ(move3, ml.at(0));
 }
 
+TEST(TypesTest, moveListFixedCapacity) {
+  Move move1 = createMove(SQ_C2, SQ_C4);
+  Move move2 = createMove(SQ_D2, SQ_D4);
+  Move move3 = createMove(SQ_E2, SQ_E4);
+  MoveList ml{move1, move2};
+  EXPECT_EQ(2, ml.size());
+  EXPECT_EQ(MAX_MOVES_PER_LIST, ml.capacity());
+
+  // copies only hold the used part and are independent
+  MoveList copy = ml;
+  copy.push_back(move3);
+  EXPECT_EQ(2, ml.size());
+  EXPECT_EQ(3, copy.size());
+  EXPECT_EQ(move3, copy.back());
+  copy.pop_back();
+  EXPECT_EQ(ml, copy);
+
+  // insert in the middle and at the end
+  MoveList dest{move1};
+  dest.insert(dest.end(), ml.begin(), ml.end());
+  EXPECT_EQ((MoveList{move1, move1, move2}), dest);
+  dest.insert(dest.begin() + 1, &move3, &move3 + 1);
+  EXPECT_EQ((MoveList{move1, move3, move1, move2}), dest);
+
+  // a list can hold the max number of moves of any position
+  MoveList full;
+  for (std::size_t i = 0; i < MAX_MOVES_PER_LIST; ++i) full.push_back(move1);
+  EXPECT_EQ(MAX_MOVES_PER_LIST, full.size());
+  full.clear();
+  EXPECT_TRUE(full.empty());
+}
+
 TEST(TypesTest, nps) {
   uint64_t nodes = 10'000'000;
   milliseconds msec{1'500};
@@ -0,0 +1,74 @@
+// FrankyCPP
+// Copyright (c) 2018-2021 Frank Kopp
+//
+// MIT License
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "init.h"
+#include "chesscore/Position.h"
+#include "engine/Search.h"
+#include "engine/SearchConfig.h"
+
+#include <benchmark/benchmark.h>
+
+// Benchmark of the search speed (nodes per second) with fixed depth
+// searches on a few middle game positions
+class SearchBench : public benchmark::Fixture {
+public:
+  void SetUp(const ::benchmark::State&) override {
+    init::init();
+    Logger::get().SEARCH_LOG->set_level(spdlog::level::warn);
+    Logger::get().UCIHAND_LOG->set_level(spdlog::level::warn);
+    SearchConfig::USE_BOOK = false;
+  }
+
+  void TearDown(const ::benchmark::State&) override {
+  }
+};
+
+BENCHMARK_DEFINE_F(SearchBench, BM_SearchNps)(benchmark::State& state) {
+  const char* const fens[] = {
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ -"};
+  Search search{};
+  search.isReady();
+  SearchLimits searchLimits{};
+  searchLimits.depth = static_cast<int>(state.range(0));
+  double nodes = 0;
+  for (auto _ : state) {
+    search.newGame();
+    for (const char* const fen : fens) {
+      search.startSearch(Position{fen}, searchLimits);
+      search.waitWhileSearching();
+      nodes += static_cast<double>(search.getLastSearchResult().nodes);
+    }
+  }
+  state.counters["Nodes"] = nodes;
+  state.counters["NPS"]   = benchmark::Counter(nodes, benchmark::Counter::kIsRate);
+}
+
+// the search runs in its own thread - therefore real time is measured
+// Depth 9 searches 3,866,139 nodes per iteration - the positions share one
+// search (history, TT) per iteration so this differs from the 3,397,924
+// nodes of three separate engine runs ("ucinewgame" + "go depth 9" each).
+BENCHMARK_REGISTER_F(SearchBench, BM_SearchNps)->Arg(9)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Search and move generation templated on node type, color and gen mode
+// (medians of alternating runs, depth 9 on the three positions above,
+// identical node count 3.397.924)
+// runtime arguments: ~1.85M nps
+// templates        : ~1.94M nps (+5%)